@@ -5,10 +5,18 @@
 #ifndef HATHAANI_DYNAMIXEL_H
 #define HATHAANI_DYNAMIXEL_H
 
+#include "atomic"
+#include "chrono"
 #include "cmath"
+#include "condition_variable"
+#include "map"
+#include "mutex"
 #include "string"
 #include "iostream"
+#include "thread"
+#include "vector"
 #include "MyDefinitions.h"
+#include "Trace.h"
 #include <dynamixel_sdk.h>
 
 #ifndef FAIL
@@ -25,6 +33,19 @@
 #define ADDR_PRESENT_POSITION       132
 #define ADDR_OPERATING_MODE         11
 #define ADDR_MOVING                 122
+#define ADDR_PRESENT_CURRENT        126
+
+#define LEN_GOAL_POSITION           4
+#define LEN_MOVING                  1
+#define LEN_PRESENT_CURRENT         2
+#define LEN_PRESENT_POSITION        4
+
+// Moving .. Present Position in one contiguous block
+#define ADDR_STATE                  ADDR_MOVING
+#define LEN_STATE                   (ADDR_PRESENT_POSITION + LEN_PRESENT_POSITION - ADDR_MOVING)
+
+#define DXL_POLL_RATE_HZ            25  // a bulk read of two servos keeps the bus busy for ~12 ms at 57600 baud
+#define DXL_SEND_TIMEOUT_MS         200 // waitUntilSent, covers a bulk read in flight before the Sync Write
 
 #define MINIMUM_POSITION_LIMIT      0  // Refer to the Minimum Position Limit of product eManual
 #define MAXIMUM_POSITION_LIMIT      4095  // Refer to the Maximum Position Limit of product eManual
@@ -80,6 +101,11 @@ public:
         return m_pPortHandler;
     }
 
+    /* Held for every transaction, the port is shared by the control and polling threads */
+    std::mutex& getMutex() {
+        return m_mutex;
+    }
+
     static dynamixel::PortHandler* getPortHandler(const std::string& s_deviceName) {
         return dynamixel::PortHandler::getPortHandler(s_deviceName.c_str());
     }
@@ -90,6 +116,7 @@ public:
 
 private:
     dynamixel::PortHandler* m_pPortHandler;
+    std::mutex m_mutex;
 };
 
 class Dynamixel {
@@ -111,11 +138,148 @@ public:
 
     bool isMoving();
 
+    [[nodiscard]] int getId() const { return m_id; }
+
+    static int32_t angleToPulse(float angle, bool isRadian = false);
+
 private:
     int m_id;
     dynamixel::PacketHandler* m_pPacketHandler;
     dynamixel::PortHandler* m_pPortHandler;
+    std::mutex* m_pPortMutex;
     bool m_bIsEnabled;
 };
 
+/* Writes one register (goal position by default) of several actuators in one Sync Write packet. Sync Write has
+ * no status packet, so a batch costs a single transmission instead of one request/response round trip per actuator.
+ * The saving has not been measured on the hardware. Estimated from the protocol 2.0 framing at DXL_BAUDRATE with the
+ * default 500 us return delay and without USB latency: 4.2 ms for both finger joints instead of 2 x 5.2 ms. */
+class DynamixelSyncWriter {
+public:
+    DynamixelSyncWriter(PortHandler& portHandler, dynamixel::PacketHandler& packetHandler,
+                        uint16_t address = ADDR_GOAL_POSITION, uint16_t length = LEN_GOAL_POSITION);
+
+    int addValue(int id, uint32_t value);
+    int addPosition(const Dynamixel& dxl, int32_t position_pulses);
+    int addPosition(const Dynamixel& dxl, float angle, bool isRadian = false);
+
+    /* Transmits all added values and clears them */
+    int send();
+
+private:
+    dynamixel::PacketHandler* m_pPacketHandler;
+    std::mutex* m_pPortMutex;
+    uint16_t m_iLength;
+    dynamixel::GroupSyncWrite m_groupSyncWrite;
+};
+
+struct DynamixelState {
+    bool bMoving = false;
+    int16_t iCurrent = 0;       // UNIT_CURRENT mA
+    int32_t iPosition = 0;      // pulses
+    bool bValid = false;        // false until the servo answered a bulk read
+};
+
+/* Reads moving flag, present current and present position of all added servos with one Bulk Read
+ * per period on a background thread and publishes them as a snapshot. */
+class DynamixelStatePoller {
+public:
+    DynamixelStatePoller(PortHandler& portHandler, dynamixel::PacketHandler& packetHandler);
+    ~DynamixelStatePoller();
+
+    int addDynamixel(const Dynamixel& dxl);
+
+    /* Polls on an own thread. Not needed when a DynamixelBus drives the poller. */
+    int start(int iRateHz = DXL_POLL_RATE_HZ);
+    void stop();
+
+    /* One bulk read transaction */
+    int poll();
+
+    bool getState(int id, DynamixelState& state) const;
+
+    /* Blocks until a snapshot taken after the call shows none of the given servos (all if empty) moving.
+     * Returns false on timeout. */
+    bool waitUntilStopped(const std::vector<int>& ids, std::chrono::milliseconds timeout);
+
+private:
+    void run(std::chrono::microseconds period);
+
+    dynamixel::PacketHandler* m_pPacketHandler;
+    std::mutex* m_pPortMutex;
+    dynamixel::GroupBulkRead m_groupBulkRead;     // guarded by the port mutex
+    std::vector<int> m_ids;                         // guarded by m_stateMutex
+
+    mutable std::mutex m_stateMutex;
+    std::condition_variable m_stateChanged;
+    std::map<int, DynamixelState> m_states;
+    uint64_t m_iNumPolls = 0;
+
+    std::thread m_pollThread;
+    std::atomic<bool> m_bRunning = false;
+};
+
+struct DynamixelCommand {
+    int id;
+    uint16_t address;
+    uint16_t length;
+    uint32_t value;
+};
+
+/* Owns all traffic on one Dynamixel port from a dedicated thread. Callers queue register writes and
+ * return right away. A queued write to the same servo and register that has not been sent yet is
+ * replaced by the newer one, and the writes of one flush that target the same register are combined
+ * into a single Sync Write. Between flushes the bus polls servo state with a bulk read. */
+class DynamixelBus {
+public:
+    DynamixelBus(PortHandler& portHandler, dynamixel::PacketHandler& packetHandler);
+    ~DynamixelBus();
+
+    int start(int iPollRateHz = DXL_POLL_RATE_HZ);
+    void stop();
+
+    /* Queues the commands, they are sent together. Never blocks on serial I/O.
+     * Returns a ticket for waitUntilSent, the last sent one if there are no commands. */
+    uint64_t write(const std::vector<DynamixelCommand>& commands);
+    /* Blocks until the write with this ticket is on the bus. FAIL on timeout or if its Sync Write,
+     * or one sent after it, failed. */
+    int waitUntilSent(uint64_t ticket, std::chrono::milliseconds timeout);
+    void setGoalPosition(const Dynamixel& dxl, int32_t position_pulses);
+    void setGoalPosition(const Dynamixel& dxl, float angle, bool isRadian = false);
+
+    int addToPoll(const Dynamixel& dxl);
+    bool getState(int id, DynamixelState& state) const;
+    bool waitUntilStopped(const std::vector<int>& ids, std::chrono::milliseconds timeout);
+
+    static DynamixelCommand goalPosition(const Dynamixel& dxl, float angle, bool isRadian = false);
+
+    [[nodiscard]] PortHandler& getPortHandler() const { return *m_pPortHandler; }
+    [[nodiscard]] dynamixel::PacketHandler& getPacketHandler() const { return *m_pPacketHandler; }
+    [[nodiscard]] uint64_t getNumCoalesced() const { return m_iNumCoalesced; }
+    [[nodiscard]] uint64_t getNumSendErrors() const { return m_iNumSendErrors; }
+
+private:
+    void run(std::chrono::microseconds pollPeriod);
+    int send(const std::vector<DynamixelCommand>& commands);
+
+    PortHandler* m_pPortHandler;
+    dynamixel::PacketHandler* m_pPacketHandler;
+    DynamixelStatePoller m_poller;
+
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueChanged;
+    std::vector<DynamixelCommand> m_queue;  // at most one command per servo and register, in order of arrival
+    std::atomic<uint64_t> m_iNumCoalesced = 0;
+
+    // write() tickets, guarded by m_queueMutex
+    std::condition_variable m_sent;
+    uint64_t m_iLastTicket = 0;
+    uint64_t m_iLastSentTicket = 0;
+    uint64_t m_iLastFailedTicket = 0;
+    std::atomic<uint64_t> m_iNumSendErrors = 0;
+
+    std::thread m_busThread;
+    std::atomic<bool> m_bRunning = false;
+};
+
 #endif //HATHAANI_DYNAMIXEL_H
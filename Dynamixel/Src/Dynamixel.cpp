@@ -4,12 +4,15 @@
 
 #include "Dynamixel.h"
 
+#include <algorithm>
+
 Dynamixel::Dynamixel(int id,
                      PortHandler& portHandler,
                      dynamixel::PacketHandler &packetHandler) :
         m_id(id),
         m_pPacketHandler(&packetHandler),
         m_pPortHandler(portHandler.getdxlPortHandler()),
+        m_pPortMutex(&portHandler.getMutex()),
         m_bIsEnabled(false) {}
 
 Dynamixel::~Dynamixel() {
@@ -21,6 +24,7 @@ Dynamixel::~Dynamixel() {
 int Dynamixel::operatingMode(OperatingMode mode) {
     uint8_t dxl_error = 0;
     int dxl_comm_result = COMM_TX_FAIL;
+    std::lock_guard<std::mutex> lock(*m_pPortMutex);
     dxl_comm_result = m_pPacketHandler->write1ByteTxRx(m_pPortHandler, m_id, ADDR_OPERATING_MODE, mode, &dxl_error);
     if (dxl_comm_result != COMM_SUCCESS) {
         printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
@@ -38,6 +42,7 @@ int Dynamixel::torque(bool bEnable) {
     uint8_t dxl_error = 0;
     int dxl_comm_result = COMM_TX_FAIL;
 
+    std::lock_guard<std::mutex> lock(*m_pPortMutex);
     dxl_comm_result = m_pPacketHandler->write1ByteTxRx(m_pPortHandler, m_id, ADDR_TORQUE_ENABLE, (uint8_t)bEnable, &dxl_error);
     if (dxl_comm_result != COMM_SUCCESS) {
         printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
@@ -58,9 +63,10 @@ int Dynamixel::torque(bool bEnable) {
 }
 
 int Dynamixel::moveToPosition(int32_t position_pulses) {
-    std::cout << (int) position_pulses << std::endl;
+    TRACE_DEBUG(Trace::DxlGoalPosition, m_id, position_pulses);
     uint8_t dxl_error = 0;
     int dxl_comm_result = COMM_TX_FAIL;
+    std::lock_guard<std::mutex> lock(*m_pPortMutex);
     dxl_comm_result = m_pPacketHandler->write4ByteTxRx(m_pPortHandler, m_id, ADDR_GOAL_POSITION, position_pulses, &dxl_error);
     if (dxl_comm_result != COMM_SUCCESS) {
         printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
@@ -74,6 +80,7 @@ int Dynamixel::moveToPosition(int32_t position_pulses) {
 int Dynamixel::getCurrentPosition(int32_t& dxl_present_position) {
     uint8_t dxl_error = 0;
     int dxl_comm_result = COMM_TX_FAIL;
+    std::lock_guard<std::mutex> lock(*m_pPortMutex);
     dxl_comm_result = m_pPacketHandler->read4ByteTxRx(m_pPortHandler, m_id, ADDR_PRESENT_POSITION, (uint32_t*)&dxl_present_position, &dxl_error);
     if (dxl_comm_result != COMM_SUCCESS) {
         printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
@@ -88,6 +95,7 @@ int Dynamixel::getCurrentPosition(int32_t& dxl_present_position) {
 int Dynamixel::setGoalCurrent(int16_t iCurrent) {
     uint8_t dxl_error = 0;
     int dxl_comm_result = COMM_TX_FAIL;
+    std::lock_guard<std::mutex> lock(*m_pPortMutex);
     dxl_comm_result = m_pPacketHandler->write2ByteTxRx(m_pPortHandler, m_id, ADDR_GOAL_CURRENT, iCurrent, &dxl_error);
     if (dxl_comm_result != COMM_SUCCESS) {
         printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
@@ -103,11 +111,14 @@ int Dynamixel::setGoalCurrent(int16_t iCurrent) {
 }
 
 int Dynamixel::moveToPosition(float angle, bool isRadian) {
+    return moveToPosition(angleToPulse(angle, isRadian));
+}
+
+int32_t Dynamixel::angleToPulse(float angle, bool isRadian) {
     if(isRadian)
         angle = angle*180.f/(float)M_PI;
 
-    auto pos = (int32_t)(angle/DEG_PULSE);
-    return moveToPosition(pos);
+    return (int32_t)(angle/DEG_PULSE);
 }
 
 int Dynamixel::getCurrentPosition(float &current_angle, bool isRadian) {
@@ -127,6 +138,7 @@ bool Dynamixel::isMoving() {
     uint8_t dxl_error = 0;
     int dxl_comm_result = COMM_TX_FAIL;
     uint8_t moving;
+    std::lock_guard<std::mutex> lock(*m_pPortMutex);
     dxl_comm_result = m_pPacketHandler->read1ByteTxRx(m_pPortHandler, m_id, ADDR_MOVING, &moving, &dxl_error);
     if (dxl_comm_result != COMM_SUCCESS) {
         printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
@@ -139,3 +151,308 @@ bool Dynamixel::isMoving() {
 
     return (bool)moving;
 }
+
+DynamixelSyncWriter::DynamixelSyncWriter(PortHandler& portHandler, dynamixel::PacketHandler& packetHandler,
+                                         uint16_t address, uint16_t length) :
+        m_pPacketHandler(&packetHandler),
+        m_pPortMutex(&portHandler.getMutex()),
+        m_iLength(length),
+        m_groupSyncWrite(portHandler.getdxlPortHandler(), &packetHandler, address, length) {}
+
+int DynamixelSyncWriter::addValue(int id, uint32_t value) {
+    // little endian, only the first m_iLength bytes are sent
+    uint8_t param[4] = {
+            DXL_LOBYTE(DXL_LOWORD(value)),
+            DXL_HIBYTE(DXL_LOWORD(value)),
+            DXL_LOBYTE(DXL_HIWORD(value)),
+            DXL_HIBYTE(DXL_HIWORD(value))
+    };
+    if (m_iLength > sizeof(param))
+        return FAIL;
+
+    // A second value for the same actuator replaces the first one
+    if (m_groupSyncWrite.changeParam(id, param) || m_groupSyncWrite.addParam(id, param))
+        return SUCCESS;
+
+    printf("[ID:%03d] groupSyncWrite addParam failed\n", id);
+    return FAIL;
+}
+
+int DynamixelSyncWriter::addPosition(const Dynamixel& dxl, int32_t position_pulses) {
+    return addValue(dxl.getId(), (uint32_t)position_pulses);
+}
+
+int DynamixelSyncWriter::addPosition(const Dynamixel& dxl, float angle, bool isRadian) {
+    return addPosition(dxl, Dynamixel::angleToPulse(angle, isRadian));
+}
+
+int DynamixelSyncWriter::send() {
+    std::unique_lock<std::mutex> lock(*m_pPortMutex);
+    int dxl_comm_result = m_groupSyncWrite.txPacket();
+    lock.unlock();
+    m_groupSyncWrite.clearParam();
+    if (dxl_comm_result != COMM_SUCCESS) {
+        printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
+        return FAIL;
+    }
+
+    return SUCCESS;
+}
+
+DynamixelStatePoller::DynamixelStatePoller(PortHandler& portHandler, dynamixel::PacketHandler& packetHandler) :
+        m_pPacketHandler(&packetHandler),
+        m_pPortMutex(&portHandler.getMutex()),
+        m_groupBulkRead(portHandler.getdxlPortHandler(), &packetHandler) {}
+
+DynamixelStatePoller::~DynamixelStatePoller() {
+    stop();
+}
+
+int DynamixelStatePoller::addDynamixel(const Dynamixel& dxl) {
+    std::lock_guard<std::mutex> portLock(*m_pPortMutex);
+    if (!m_groupBulkRead.addParam(dxl.getId(), ADDR_STATE, LEN_STATE)) {
+        printf("[ID:%03d] groupBulkRead addParam failed\n", dxl.getId());
+        return FAIL;
+    }
+
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_ids.push_back(dxl.getId());
+    m_states[dxl.getId()] = DynamixelState();
+    return SUCCESS;
+}
+
+int DynamixelStatePoller::start(int iRateHz) {
+    if (m_bRunning || iRateHz <= 0)
+        return FAIL;
+
+    m_bRunning = true;
+    m_pollThread = std::thread(&DynamixelStatePoller::run, this, std::chrono::microseconds(1000000 / iRateHz));
+    return SUCCESS;
+}
+
+void DynamixelStatePoller::stop() {
+    m_bRunning = false;
+    if (m_pollThread.joinable())
+        m_pollThread.join();
+}
+
+void DynamixelStatePoller::run(std::chrono::microseconds period) {
+    auto nextPoll = std::chrono::steady_clock::now();
+    while (m_bRunning) {
+        poll();
+        nextPoll = std::max(nextPoll + period, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(nextPoll);
+    }
+}
+
+int DynamixelStatePoller::poll() {
+    std::unique_lock<std::mutex> portLock(*m_pPortMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (m_ids.empty())
+            return SUCCESS;
+    }
+    int dxl_comm_result = m_groupBulkRead.txRxPacket();
+
+    if (dxl_comm_result != COMM_SUCCESS)
+        printf("%s\n", m_pPacketHandler->getTxRxResult(dxl_comm_result));
+
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        for (int id : m_ids) {
+            auto& state = m_states[id];
+            state.bValid = (dxl_comm_result == COMM_SUCCESS && m_groupBulkRead.isAvailable(id, ADDR_STATE, LEN_STATE));
+            if (!state.bValid)
+                continue;
+
+            state.bMoving = (bool)m_groupBulkRead.getData(id, ADDR_MOVING, LEN_MOVING);
+            state.iCurrent = (int16_t)m_groupBulkRead.getData(id, ADDR_PRESENT_CURRENT, LEN_PRESENT_CURRENT);
+            state.iPosition = (int32_t)m_groupBulkRead.getData(id, ADDR_PRESENT_POSITION, LEN_PRESENT_POSITION);
+        }
+        ++m_iNumPolls;
+    }
+    portLock.unlock();
+    m_stateChanged.notify_all();
+
+    return (dxl_comm_result == COMM_SUCCESS) ? SUCCESS : FAIL;
+}
+
+bool DynamixelStatePoller::getState(int id, DynamixelState& state) const {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    auto it = m_states.find(id);
+    if (it == m_states.end())
+        return false;
+
+    state = it->second;
+    return state.bValid;
+}
+
+bool DynamixelStatePoller::waitUntilStopped(const std::vector<int>& ids, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    // A servo that was just commanded may not report moving yet, so skip the snapshot in flight
+    auto iFirstPoll = m_iNumPolls + 2;
+    return m_stateChanged.wait_for(lock, timeout, [this, iFirstPoll, &ids] {
+        if (m_iNumPolls < iFirstPoll)
+            return false;
+
+        for (const auto& [id, state] : m_states) {
+            if (!ids.empty() && std::find(ids.begin(), ids.end(), id) == ids.end())
+                continue;
+            if (!state.bValid || state.bMoving)
+                return false;
+        }
+        return true;
+    });
+}
+
+DynamixelBus::DynamixelBus(PortHandler& portHandler, dynamixel::PacketHandler& packetHandler) :
+        m_pPortHandler(&portHandler),
+        m_pPacketHandler(&packetHandler),
+        m_poller(portHandler, packetHandler) {}
+
+DynamixelBus::~DynamixelBus() {
+    stop();
+}
+
+int DynamixelBus::start(int iPollRateHz) {
+    if (m_bRunning || iPollRateHz <= 0)
+        return FAIL;
+
+    m_bRunning = true;
+    m_busThread = std::thread(&DynamixelBus::run, this, std::chrono::microseconds(1000000 / iPollRateHz));
+    return SUCCESS;
+}
+
+void DynamixelBus::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_bRunning = false;
+    }
+    m_queueChanged.notify_one();
+    if (m_busThread.joinable())
+        m_busThread.join();
+}
+
+uint64_t DynamixelBus::write(const std::vector<DynamixelCommand>& commands) {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        // nothing to send, so nothing to wait for: the bus thread only marks tickets sent when it had commands
+        if (commands.empty())
+            return m_iLastSentTicket;
+
+        ticket = ++m_iLastTicket;
+        for (const auto& command : commands) {
+            auto it = std::find_if(m_queue.begin(), m_queue.end(), [&command](const DynamixelCommand& queued) {
+                return queued.id == command.id && queued.address == command.address;
+            });
+
+            if (it != m_queue.end()) {
+                *it = command;
+                ++m_iNumCoalesced;
+            } else {
+                m_queue.push_back(command);
+            }
+        }
+    }
+    m_queueChanged.notify_one();
+    return ticket;
+}
+
+int DynamixelBus::waitUntilSent(uint64_t ticket, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    if (!m_sent.wait_for(lock, timeout, [this, ticket] { return m_iLastSentTicket >= ticket; }))
+        return FAIL;
+
+    return (m_iLastFailedTicket >= ticket) ? FAIL : SUCCESS;
+}
+
+void DynamixelBus::setGoalPosition(const Dynamixel& dxl, int32_t position_pulses) {
+    write({{dxl.getId(), ADDR_GOAL_POSITION, LEN_GOAL_POSITION, (uint32_t)position_pulses}});
+}
+
+void DynamixelBus::setGoalPosition(const Dynamixel& dxl, float angle, bool isRadian) {
+    write({goalPosition(dxl, angle, isRadian)});
+}
+
+DynamixelCommand DynamixelBus::goalPosition(const Dynamixel& dxl, float angle, bool isRadian) {
+    return {dxl.getId(), ADDR_GOAL_POSITION, LEN_GOAL_POSITION, (uint32_t)Dynamixel::angleToPulse(angle, isRadian)};
+}
+
+int DynamixelBus::addToPoll(const Dynamixel& dxl) {
+    return m_poller.addDynamixel(dxl);
+}
+
+bool DynamixelBus::getState(int id, DynamixelState& state) const {
+    return m_poller.getState(id, state);
+}
+
+bool DynamixelBus::waitUntilStopped(const std::vector<int>& ids, std::chrono::milliseconds timeout) {
+    return m_poller.waitUntilStopped(ids, timeout);
+}
+
+void DynamixelBus::run(std::chrono::microseconds pollPeriod) {
+    std::vector<DynamixelCommand> commands;
+    auto nextPoll = std::chrono::steady_clock::now();
+    while (true) {
+        bool bRunning;
+        uint64_t ticket;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueChanged.wait_until(lock, nextPoll, [this] { return !m_queue.empty() || !m_bRunning; });
+            commands.swap(m_queue);
+            ticket = m_iLastTicket;
+            bRunning = m_bRunning;
+        }
+
+        // Commands first, polling only uses the bus time that is left
+        if (!commands.empty()) {
+            int result = send(commands);
+            commands.clear();
+
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                m_iLastSentTicket = ticket;
+                if (result != SUCCESS) {
+                    m_iLastFailedTicket = ticket;
+                    ++m_iNumSendErrors;
+                }
+            }
+            m_sent.notify_all();
+        }
+
+        // Commands queued before stop() still go out
+        if (!bRunning)
+            break;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextPoll) {
+            m_poller.poll();
+            nextPoll = std::max(nextPoll + pollPeriod, now);
+        }
+    }
+}
+
+int DynamixelBus::send(const std::vector<DynamixelCommand>& commands) {
+    // One Sync Write per register, in order of the register's first command
+    int result = SUCCESS;
+    std::vector<bool> bSent(commands.size(), false);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (bSent[i])
+            continue;
+
+        DynamixelSyncWriter writer(*m_pPortHandler, *m_pPacketHandler, commands[i].address, commands[i].length);
+        for (size_t j = i; j < commands.size(); ++j) {
+            if (commands[j].address != commands[i].address || commands[j].length != commands[i].length)
+                continue;
+            if (writer.addValue(commands[j].id, commands[j].value) != SUCCESS)
+                result = FAIL;
+            TRACE_DEBUG(Trace::DxlSyncWrite, commands[j].id, (int32_t)commands[j].value);
+            bSent[j] = true;
+        }
+
+        if (writer.send() != SUCCESS)
+            result = FAIL;
+    }
+    return result;
+}
@@ -37,7 +37,7 @@ public:
     static Error_t Create(BowController*& pCInstance);
     static Error_t Destroy(BowController*& pCInstance);
 
-    Error_t Init(CommHandler* commHandler, PortHandler& portHandler, int* RTPosition);
+    Error_t Init(CommHandler* commHandler, DynamixelBus& dxlBus, int* RTPosition);
     Error_t Reset();
 
     Error_t RosinMode();
@@ -63,7 +63,7 @@ private:
 
     bool m_bInitialized;
     CommHandler* m_commHandler;
-    PortHandler* m_pPortHandler;
+    DynamixelBus* m_pDxlBus;
     State m_bowingState;
     uint8_t m_iBowSpeed;
     float m_fBowPressure;
@@ -36,6 +36,7 @@ public:
             bcm2835_spi_end();
         bcm2835_close();
 #endif // __arm__
+        delete m_pDxlBus;
         m_bInitialized = false;
     }
 
@@ -96,6 +97,10 @@ public:
         return m_pPortHandler;
     }
 
+    DynamixelBus* getDxlBus() {
+        return m_pDxlBus;
+    }
+
 private:
     Error_t Init() {
         m_pPortHandler = new PortHandler(DXL_DEVICE_NAME);
@@ -108,6 +113,12 @@ private:
             LOG_ERROR("Cannot set baudrate...");
             return kSetValueError;
         }
+
+        m_pDxlBus = new DynamixelBus(*m_pPortHandler, *PortHandler::getPacketHandler());
+        if (m_pDxlBus->start() != SUCCESS) {
+            LOG_ERROR("Cannot start dynamixel bus thread...");
+            return kNotInitializedError;
+        }
 #ifdef __arm__
         Error_t err;
         if (m_protocol == I2C) {
@@ -168,6 +179,7 @@ private:
     bool m_bInitialized = false;
 
     PortHandler* m_pPortHandler = nullptr;
+    DynamixelBus* m_pDxlBus = nullptr;
 };
 
 
@@ -5,6 +5,7 @@
 #ifndef HATHAANI_EPOSCONTROLLER_H
 #define HATHAANI_EPOSCONTROLLER_H
 
+#include <atomic>
 #include <iostream>
 #include <cstring>
 #include <string>
@@ -29,7 +30,13 @@ class EposController
 {
 public:
     enum OperationMode {
-        Position, ProfilePosition, ProfileVelocity
+        Position, ProfilePosition, ProfileVelocity, InterpolatedPosition
+    };
+
+    struct IpmStatus {
+        bool bTrajectoryRunning = false;
+        bool bUnderflowWarning = false;
+        bool bError = false;    // any of the underflow / overflow / velocity / acceleration errors
     };
 
     explicit EposController(std::string portName, int iNodeID);
@@ -42,20 +49,37 @@ public:
     Error_t ActivateProfilePositionMode();
     Error_t ActivatePositionMode();
     Error_t ActivateProfileVelocityMode();
+    Error_t ActivateInterpolatedPositionMode();
+    Error_t ActivateOperationMode(OperationMode mode);
+    [[nodiscard]] OperationMode getOperationMode() const { return m_operationMode; }
 
     Error_t SetPositionProfile(unsigned long ulVelocity, unsigned long ulAcc);
     Error_t SetVelocityProfile(unsigned long ulAcc);
 
+    // Only in (profile) position mode, kFunctionIllegalCallError otherwise
     Error_t moveToPositionl(long targetPos);
     Error_t MoveToPosition(long lPos, unsigned long ulAcc, BOOL bAbsolute, int iTimeOut = 50);
 
     Error_t MoveWithVelocity(long lVelocity);
+
+    // Quad counts per motor revolution of the incremental encoder configured on the drive
+    Error_t GetEncoderIncPerTurn(int& iIncPerTurn);
+    /* kNoError if the drive's encoder matches ENCODER_INC_PER_TURN, which the PVT points are computed with.
+     * kGetValueError if it does not or cannot be read (only the first encoder's resolution can). */
+    Error_t CheckEncoderIncPerTurn();
+
+    // Interpolated position mode. lVelocity is in rpm, uiTimeMs is the duration until the next point (0 ends the trajectory)
+    Error_t AddPvtPoint(long lPosition, long lVelocity, uint8_t uiTimeMs);
+    Error_t GetFreeIpmBufferSize(unsigned int& uiBufferSize);
+    Error_t GetIpmStatus(IpmStatus& status);
+    Error_t StartIpmTrajectory();
+    Error_t StopIpmTrajectory();
     Error_t Halt();
 
     virtual Error_t setHome();
 
 private:
-    OperationMode m_operationMode = Position;
+    std::atomic<OperationMode> m_operationMode = Position;     // read by the tracking and the perform thread
     int m_iEncoderDirection = -1;
 
     HANDLE pKeyHandle = nullptr;
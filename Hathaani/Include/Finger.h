@@ -66,15 +66,30 @@ public:
 
 class Finger {
 public:
+    // Joint angle grid for calcIKInterpolated, 1 mm apart around the fingering point. Bilinear
+    // interpolation is within 0.011 deg of calcIK there (FingerIKTest), a Dynamixel step is 0.088 deg.
+    static constexpr float kGridMinX = -163, kGridMaxX = -143;
+    static constexpr float kGridMinY = 10, kGridMaxY = 50;
+    static constexpr float kGridStep = 1;
+    static const int kGridNumX = 21;
+    static const int kGridNumY = 41;
+
+    // Recent calcIK targets that are answered without solving again (On / Off only ever ask for two)
+    static const int kIKCacheSize = 4;
+
     explicit Finger(float D = 32);
     ~Finger();
 
-    Error_t init(PortHandler& portHandler);
+    Error_t init(DynamixelBus& bus);
     Error_t reset();
 
-    void wait();
+    /* Blocks until both joints have stopped, or the timeout expired (kTimeoutError) */
+    Error_t wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(FINGER_WAIT_TIMEOUT_MS));
+    /* Joint angles for the finger tip at (x, y), read back with getDriveAngles. They stay unchanged if (x, y) is out of reach. */
     Error_t calcIK(float x, float y);
-    Error_t moveToPosition(float x, float y, bool bWait = false);
+    /* Same from the precomputed grid, for targets that change every frame. Falls back to calcIK outside of it. */
+    Error_t calcIKInterpolated(float x, float y);
+    Error_t moveToPosition(float x, float y, bool bWait = false, bool bInterpolate = false);
     Error_t moveJoints(float* pfTheta, bool bWait = false, bool isRadian = false);
     void getDriveAngles(float& angle0, float& angle1) const;
 
@@ -87,9 +102,23 @@ public:
     }
 
 private:
+    struct IKSolution {
+        float x = NAN, y = NAN;
+        float theta1 = 0, theta2 = 0;
+    };
+
+    Error_t solveIK(float x, float y, float& fTheta1, float& fTheta2);
+    void initGrid();
+
     float m_fD;
     float _theta1 = 0, _theta2 = 0;
 
+    IKSolution m_ikCache[kIKCacheSize];
+    int m_iNextCacheEntry = 0;
+
+    float m_afGrid[kGridNumY][kGridNumX][2] = {};  // theta1, theta2
+    bool m_abGridValid[kGridNumY][kGridNumX] = {};
+
     Link m_links[4] = {
             Link(0, 0, 60, 0.f),
             Link(0, 0, 160, 0.f),
@@ -99,7 +128,7 @@ private:
 
     bool m_bInitialized = false;
 
-    PortHandler* m_pPortHandler;
+    DynamixelBus* m_pDxlBus;
     std::vector<Dynamixel> m_dxl;
 };
 
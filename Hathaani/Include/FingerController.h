@@ -24,7 +24,7 @@ class FingerController: public EposController {
     inline static const std::string kName = "FingerController";
 
 public:
-    FingerController(CommHandler* pCommHandler, PortHandler& portHandler);
+    FingerController(CommHandler* pCommHandler, DynamixelBus& dxlBus);
     ~FingerController() override;
 //    static Error_t Create(FingerController* &pFinger);
 //    static Error_t Destroy(FingerController* &pFinger);
@@ -43,16 +43,22 @@ public:
     Error_t Rest();
     Error_t On();
     Error_t Off();
+    /* Continuous alternative to On / Off for finger pressure: moves the tip to fHeight (FINGER_ON pressed,
+     * FINGER_OFF lifted) with the interpolated IK, cheap enough to call every frame */
+    Error_t setFingerHeight(float fHeight);
 
 //    Error_t SetPositionProfile(unsigned long ulVelocity = 2500, unsigned long ulAcc = 10000);
 //    Error_t moveToPosition(long targetPos);
     Error_t moveToPosition(float fFretPosition);
 
 private:
+    static constexpr float kFingerX = -153;     // finger tip position along the string axis of the linkage
+
     enum State {
         OFF = 0,
         ON,
-        REST
+        REST,
+        HEIGHT      // set by setFingerHeight, the next On / Off always moves
     };
 
     uint8_t prevSentValue;
@@ -0,0 +1,91 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_FRAMESCHEDULER_H
+#define HATHAANI_FRAMESCHEDULER_H
+
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "MyDefinitions.h"
+#include "Span.h"
+
+/* Runs pitch frames against an absolute timeline so that actuator I/O inside a frame
+ * does not push the following frames back. Frame i is due at start + i * hopSize,
+ * or at start + timeStamps[i] when the score carries explicit timestamps. */
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameScheduler(std::chrono::microseconds hopSize = std::chrono::microseconds(PITCH_HOP_SIZE_US),
+                            std::chrono::microseconds spinTime = std::chrono::microseconds(SCHEDULER_SPIN_US)) :
+                            m_hopSize(hopSize), m_spinTime(spinTime) {
+        // next() catches up by stepping hop by hop, which never ends on a zero hop
+        assert(hopSize.count() > 0);
+    }
+
+    /* Use explicit per-frame timestamps (in seconds from the first frame) instead of a fixed hop.
+     * Frames past the last timestamp continue at the hop size. */
+    void setTimeStamps(Span<float> timeStamps) {
+        m_timeStamps.resize(timeStamps.size());
+        for (size_t i = 0; i < timeStamps.size(); ++i)
+            m_timeStamps[i] = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(timeStamps[i]));
+    }
+
+    void start() {
+        m_iDroppedFrames = 0;
+        m_startTime = Clock::now();
+    }
+
+    [[nodiscard]] Clock::time_point getDeadline(size_t iFrame) const {
+        if (m_timeStamps.empty())
+            return m_startTime + iFrame * m_hopSize;
+
+        if (iFrame < m_timeStamps.size())
+            return m_startTime + m_timeStamps[iFrame];
+
+        return m_startTime + m_timeStamps.back() + (iFrame - m_timeStamps.size() + 1) * m_hopSize;
+    }
+
+    /* Waits for the frame after iFrame and returns its index. A frame that is late by less
+     * than a hop is run immediately to catch up. If the caller is further behind, the frames
+     * whose slots have already passed are dropped and the currently due frame is returned. */
+    size_t next(size_t iFrame) {
+        size_t iNext = iFrame + 1;
+        auto now = Clock::now();
+        if (now < getDeadline(iNext + 1)) {
+            waitUntil(getDeadline(iNext));
+            return iNext;
+        }
+
+        while (now >= getDeadline(iNext + 1)) {
+            ++iNext;
+            ++m_iDroppedFrames;
+        }
+        return iNext;
+    }
+
+    /* Sleeps until shortly before the deadline and spins for the rest */
+    void waitUntil(Clock::time_point deadline) const {
+        if (deadline - Clock::now() > m_spinTime)
+            std::this_thread::sleep_until(deadline - m_spinTime);
+
+        while (Clock::now() < deadline);
+    }
+
+    [[nodiscard]] size_t getNumDroppedFrames() const {
+        return m_iDroppedFrames;
+    }
+
+private:
+    std::chrono::microseconds m_hopSize;
+    std::chrono::microseconds m_spinTime;
+    std::vector<Clock::duration> m_timeStamps;
+    Clock::time_point m_startTime;
+    size_t m_iDroppedFrames = 0;
+};
+
+#endif //HATHAANI_FRAMESCHEDULER_H
@@ -12,6 +12,7 @@
 #include <cmath>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <sstream>
 
 #include "Logger.h"
@@ -21,7 +22,13 @@
 #include "FingerController.h"
 #include "CommHandler.h"
 #include "BowController.h"
+#include "FrameScheduler.h"
+#include "IpmTrajectory.h"
+#include "TrajectoryCompiler.h"
 #include "Util.h"
+#include "Score.h"
+#include "ScoreCache.h"
+#include "Setpoint.h"
 
 #include "Tuner.h"
 
@@ -54,11 +61,23 @@ public:
     Hathaani();
     ~Hathaani();
 
-    Error_t init(bool shouldHome = true, bool usePitchCorrection = false);
+    Error_t init(bool shouldHome = true, bool usePitchCorrection = false, int trackingRateHz = TRACKING_RATE_HZ);
 
     Error_t ApplyRosin(int time = 10 /* sec */);
+
+    /* Finger slide mode used by Perform(pitches, ...). InterpolatedPosition streams the whole
+     * pitch track to the drive as PVT points, anything else sends one target per frame. */
+    void setOperationMode(EposController::OperationMode mode);
 //    Error_t Perform(const std::vector<float>& pitches, const std::vector<size_t>& bowChange, float amplitude, int8_t transpose);
-    Error_t Perform(const std::vector<float>& pitches, const std::vector<size_t>& bowChange, const std::vector<float>& amplitude, float maxAmplitude, int8_t transpose);
+    Error_t Perform(const std::vector<float>& pitches, const std::vector<size_t>& bowChange, const std::vector<float>& amplitude, float maxAmplitude, int8_t transpose,
+                    float hopSize = PITCH_HOP_SIZE_US * 1e-6f, const std::vector<float>& timeStamps = {});
+    /* Same as above on views, e.g. straight from a mapped BinaryScore */
+    Error_t Perform(const Score& score, float maxAmplitude, int8_t transpose);
+    /* Same as above with the trajectory compiled beforehand (CompileTrajectory or a ScoreCache).
+     * kFunctionInvalidArgsError if it was compiled for another transposition. */
+    Error_t Perform(const Score& score, const ScoreTrajectory& trajectory, float maxAmplitude, int8_t transpose);
+    /* Offline part of Perform. The PVT points are only needed in InterpolatedPosition mode. */
+    static Error_t CompileTrajectory(ScoreTrajectory& trajectory, const Score& score, int8_t transpose, bool bComputePvt = true);
 //    Error_t Perform(const double* pitches, const size_t& length, const std::vector<size_t>& bowChange, float amplitude, int8_t transpose);
     Error_t Perform(Key key, Mode mode, int interval_ms, float amplitude, short transpose=0);
     // Refer: https://docs.google.com/document/d/1pFtqsbGZRWFdYnXaYPe7DsxtM3WqSJLXV0DlrrbXF2c/edit#heading=h.85q2gj4ocoei
@@ -68,6 +87,7 @@ public:
     static Error_t GetPositionsForScale(std::vector<float>& positions, Key key, Mode mode, short transpose=0);
 
     void TrackTargetPosition();
+    [[nodiscard]] size_t getNumSuppressedWrites() const;
 
     static void LogInfo(const string& message);
     static void LogError(const string& functionName, Error_t p_lResult, unsigned int p_ulErrorCode);
@@ -88,17 +108,30 @@ private:
 
     void PitchCorrect();
 
+    void SetFretPosition(float fFretPosition);
+    void PublishSetpoint();
+
     int m_iRTPosition;
 
     int m_iTimeInterval = 10; //ms
+    int m_iTrackingRateHz = TRACKING_RATE_HZ;
+
+    // Written by the perform thread only, published through m_setpointChannel
+    Setpoint m_setpoint;
+    SetpointChannel m_setpointChannel;
+    std::atomic<float> m_fPitchCorrection = 0;
 
-    float m_fFretPosition = 0;
+    // Last pulse target sent to the finger EPOS, used to skip unchanged writes
+    long m_lLastTargetPosition = -1;
+    unsigned long m_ulLastProfileVelocity = 0;
+    std::atomic<size_t> m_iPositionWrites = 0;
+    std::atomic<size_t> m_iSuppressedWrites = 0;
 
     unsigned int ulErrorCode = 0;
 
     unsigned int m_ulMaxFollowErr = 20000;
 
-    bool m_bStopPositionUpdates;
+    std::atomic<bool> m_bStopPositionUpdates;
     bool m_bShouldHome = false;
     bool m_bTunerOn = false;
     bool m_bUsePitchCorrection = false;
@@ -107,6 +140,7 @@ private:
     std::thread positionTrackThread;
 
     EposController::OperationMode m_operationMode = EposController::Position;
+    IpmTrajectory m_ipmTrajectory;
 
     // Communication Handlers
     CommHandler* m_pCommHandler;
@@ -0,0 +1,68 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_IPMTRAJECTORY_H
+#define HATHAANI_IPMTRAJECTORY_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "EposController.h"
+#include "Logger.h"
+#include "MyDefinitions.h"
+#include "TrajectoryCompiler.h"
+#include "Util.h"
+
+struct PvtPoint {
+    long lPosition;     // encoder pulses
+    long lVelocity;     // rpm
+    uint8_t uiTimeMs;   // duration until the next point, 0 for the last one
+};
+
+/* Streams a precomputed finger trajectory into the EPOS interpolated position mode buffer.
+ * The drive interpolates between the points on board, so the host only has to keep the
+ * buffer topped up instead of sending a set point every frame. */
+class IpmTrajectory {
+public:
+    inline static const std::string kName = "IpmTrajectory";
+
+    IpmTrajectory() = default;
+    ~IpmTrajectory() = default;
+
+    /* Converts compiled motion segments into PVT points at the segment boundaries (and every quarter
+     * period of an oscillation). Frame times come from timeStamps (seconds) when given, otherwise
+     * from hopSize (seconds). */
+    static Error_t Compute(std::vector<PvtPoint>& points, const std::vector<MotionSegment>& segments, int8_t transpose,
+                           float hopSize, Span<float> timeStamps = {});
+
+    /* Switches the controller to interpolated position mode and preloads the buffer.
+     * Stop (and Reset) switch it back to the mode it was in before. */
+    Error_t Init(EposController* pController, std::vector<PvtPoint> points);
+    Error_t Reset();
+
+    /* One step of the tracking thread: adds as many pending points as the drive buffer has room for while
+     * a trajectory is loaded (Init until Stop), otherwise calls updateTarget. Both run under the lock Init / Start / Stop take, so the
+     * tracking thread never talks to the drive while its operation mode is being switched. bLoaded tells
+     * which of the two ran. */
+    Error_t Track(const std::function<Error_t()>& updateTarget, bool& bLoaded);
+    Error_t Start();
+    Error_t Stop();
+
+    [[nodiscard]] bool isStreaming() const { return m_bStreaming; }
+    [[nodiscard]] size_t getNumPoints() const { return m_points.size(); }
+
+private:
+    Error_t FillBuffer();
+
+    std::mutex m_mutex;     // Track runs on the tracking thread, Init/Start/Stop/Reset on the perform thread
+    EposController* m_pController = nullptr;
+    EposController::OperationMode m_previousMode = EposController::ProfilePosition;
+    std::vector<PvtPoint> m_points;
+    size_t m_iNextPoint = 0;
+    std::atomic<bool> m_bStreaming = false;
+};
+
+#endif //HATHAANI_IPMTRAJECTORY_H
@@ -6,11 +6,11 @@
 #define HATHAANI_PITCHFILEPARSER_H
 
 #include <fstream>
+#include <iostream>
 #include <memory>
 #include <vector>
 
 #include "MyDefinitions.h"
-#include "rapidjson/document.h"
 
 using std::string;
 using std::cout;
@@ -29,8 +29,18 @@ public:
     Error_t GetLength(size_t& length, const Error_t&  error = kNoError);
     Error_t GetPitches(double* pitches, const size_t &length = 0, const Error_t& error = kNoError);
 
+    /* The score is streamed through a SAX reader straight into the vectors, without holding the
+     * file text or a DOM in memory. Unknown members are skipped. */
     Error_t parseJson(std::vector<float>& pitches, std::vector<size_t>& bowChanges, std::vector<float>& amplitude);
+    /* Optional score timing: "hop" is the frame period in seconds (MIN_HOP_SIZE to MAX_HOP_SIZE), "time"
+     * holds one timestamp (seconds from the first frame) per pitch frame. hopSize falls back to PITCH_HOP_SIZE_US
+     * and timeStamps is left empty when the score does not carry them. */
+    Error_t parseJson(std::vector<float>& pitches, std::vector<size_t>& bowChanges, std::vector<float>& amplitude,
+                      float& hopSize, std::vector<float>& timeStamps);
 private:
+    static const size_t kReadBufferSize = 1 << 16;
+    static const size_t kBytesPerFrameEstimate = 16;
+
     Error_t readPitches();
     Error_t readSize();
 
@@ -0,0 +1,78 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_SCORE_H
+#define HATHAANI_SCORE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MyDefinitions.h"
+#include "Span.h"
+
+/* Everything Hathaani::Perform reads from a score, as views into memory owned elsewhere:
+ * the vectors filled by PitchFileParser or a mapped BinaryScore. */
+struct Score {
+    Span<float> pitches;            // fret positions, negative for rests
+    Span<float> amplitude;          // bow amplitude per frame, 0..1
+    Span<uint8_t> bowChange;        // non zero where the bow changes direction
+    Span<float> timeStamps;         // optional, seconds from the first frame
+    float hopSize = PITCH_HOP_SIZE_US * 1e-6f;
+
+    /* Per frame flags from a list of frame indices (as PitchFileParser reads them) */
+    static void FlagBowChanges(std::vector<uint8_t>& flags, const std::vector<size_t>& bowChanges, size_t iNumFrames);
+};
+
+/* Score file that is used in place: the columns are mapped into memory and handed out as spans,
+ * so a performance starts without parsing or copying the score. Little endian:
+ *
+ *   offset  size  content
+ *        0     4  magic "HSCR"
+ *        4     4  uint32 version (kVersion)
+ *        8     4  uint32 flags (kHasTimeStamps)
+ *       12     4  float32 hop size in seconds
+ *       16     8  uint64 number of frames N
+ *       24    40  zero
+ *       64    4N  float32 pitch
+ *             4N  float32 amplitude
+ *             4N  float32 time stamps, only with kHasTimeStamps
+ *              N  uint8 bow change flags
+ *
+ * Every column starts on a kAlignment byte boundary. */
+class BinaryScore {
+public:
+    inline static const std::string kName = "BinaryScore";
+
+    static const uint32_t kVersion = 1;
+    static const uint32_t kHasTimeStamps = 0x1;
+    static const size_t kAlignment = 64;
+
+    BinaryScore() = default;
+    ~BinaryScore();
+    BinaryScore(const BinaryScore&) = delete;
+    BinaryScore& operator=(const BinaryScore&) = delete;
+
+    /* Maps the file read only and checks the header and the file size. The pages are faulted
+     * in here so that the performance does not wait on the disk. */
+    Error_t Open(const std::string& filePath);
+    void Close();
+
+    /* Views into the mapping, valid until Close() */
+    [[nodiscard]] const Score& GetScore() const { return m_score; }
+
+    /* Writes a score in this format. Time stamps have to be empty or one per frame and must not
+     * decrease, since Open() does not look at the data. */
+    static Error_t Write(const std::string& filePath, const Score& score);
+
+    /* Whether the file starts with the magic of this format */
+    static bool IsBinaryScore(const std::string& filePath);
+
+private:
+    void* m_pMapping = nullptr;
+    size_t m_iMappingSize = 0;
+    Score m_score;
+};
+
+#endif //HATHAANI_SCORE_H
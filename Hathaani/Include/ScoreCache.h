@@ -0,0 +1,68 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_SCORECACHE_H
+#define HATHAANI_SCORECACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "IpmTrajectory.h"
+#include "MyDefinitions.h"
+#include "Score.h"
+#include "TrajectoryCompiler.h"
+
+/* Everything Perform derives from a score before the first frame */
+struct ScoreTrajectory {
+    std::vector<MotionSegment> segments;
+    std::vector<PvtPoint> pvtPoints;    // encoder pulse targets for the interpolated position mode
+    std::vector<FrameTarget> frames;    // one per score frame
+    int8_t transpose = 0;               // the frames and the PVT points are transposed by this much
+};
+
+/* On disk cache of preprocessed scores, so a restart on the same piece skips the JSON parser and
+ * the trajectory compiler. Entries are keyed by a hash of the score file's content, so an edited
+ * score simply misses and gets a new entry:
+ *
+ *   <key>.hsc              the score as a BinaryScore
+ *   <key>-<config>.trj     its ScoreTrajectory, config covers the transposition, the calibration and
+ *                          compiler constants and kVersion
+ *
+ * Entries are written to a temporary file and renamed, so an interrupted run never leaves a half
+ * written one. Stale entries are not removed, the directory can be deleted at any time. */
+class ScoreCache {
+public:
+    inline static const std::string kName = "ScoreCache";
+
+    // bump when the trajectory compiler or IpmTrajectory::Compute change their output
+    static const uint32_t kVersion = 2;
+
+    explicit ScoreCache(std::string directory = SCORE_CACHE_DIR);
+
+    /* Maps the cached binary score of a JSON score. On a miss the JSON is parsed and the entry written first.
+     * A BinaryScore file is mapped in place and only gets its trajectories cached. */
+    Error_t Load(const std::string& scorePath, BinaryScore& binaryScore);
+
+    /* Trajectory of the last loaded score, kFileOpenError if there is none for this transposition yet */
+    Error_t LoadTrajectory(ScoreTrajectory& trajectory, int8_t transpose) const;
+    /* Stored under the trajectory's own transposition */
+    Error_t StoreTrajectory(const ScoreTrajectory& trajectory) const;
+
+    /* Whether the last Load found its entry */
+    [[nodiscard]] bool isHit() const { return m_bHit; }
+
+    /* 64 bit content hash (MurmurHash3 style mixing, not cryptographic) */
+    static uint64_t Hash(const void* pData, size_t iSize, uint64_t uiSeed = 0);
+    static Error_t HashFile(uint64_t& uiHash, const std::string& filePath);
+
+private:
+    [[nodiscard]] std::string GetTrajectoryPath(int8_t transpose) const;
+
+    std::string m_directory;
+    std::string m_key;      // hex content hash of the last loaded score
+    bool m_bHit = false;
+};
+
+#endif //HATHAANI_SCORECACHE_H
@@ -0,0 +1,79 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_TRAJECTORYCOMPILER_H
+#define HATHAANI_TRAJECTORYCOMPILER_H
+
+#include <vector>
+
+#include "MyDefinitions.h"
+#include "Span.h"
+#include "Util.h"
+
+/* One motion primitive of the finger slide, covering frames [iStartFrame, iEndFrame).
+ * Values are fret positions (semitones, not transposed). */
+struct MotionSegment {
+    enum Type {
+        Hold,           // fStart
+        Ramp,           // linear from fStart at iStartFrame to fEnd at iEndFrame - 1
+        Oscillation     // fCenter + fDepth * cos(pi * (i - iStartFrame) / fHalfPeriod), kampita like
+    };
+
+    Type type = Hold;
+    size_t iStartFrame = 0;
+    size_t iEndFrame = 0;
+
+    float fStart = 0;
+    float fEnd = 0;
+
+    float fCenter = 0;
+    float fDepth = 0;       // signed, positive when the oscillation starts on a peak
+    float fHalfPeriod = 0;  // frames
+};
+
+/* What the perform loop publishes for one frame, converted ahead of time so that the real time
+ * threads only copy it. Transposed, unlike the segments. */
+struct FrameTarget {
+    float fFretPosition = 0;            // where the pitch is in this frame
+    float fSlideTarget = 0;             // fret position the slide is moving towards
+    float fSlideSpeed = 0;              // frets per second for that move, 0 for the default profile
+    long lSlideTarget = 0;              // fSlideTarget in encoder pulses
+    unsigned long ulSlideVelocity = 0;  // profile velocity (rpm) for that move
+};
+
+/* Offline step between PitchFileParser and Hathaani::Perform: segments a pitch track into holds,
+ * ramps and oscillations so that the executor only has to send the segment boundaries. */
+class TrajectoryCompiler {
+public:
+    inline static const std::string kName = "TrajectoryCompiler";
+
+    /* Rests (negative pitches) hold the previous position. fTolerance is the largest deviation
+     * (semitones) a hold or ramp may have from the pitch track, oscillations are allowed
+     * OSCILLATION_TOLERANCE_FACTOR times as much. hopSize (seconds) bounds the oscillation rate. */
+    static Error_t Compile(std::vector<MotionSegment>& segments, Span<float> pitches,
+                           float hopSize, float fTolerance = TRAJECTORY_TOLERANCE);
+
+    /* Samples the segments at every frame and converts the slide targets to pulses. Frame lengths come
+     * from timeStamps (seconds) when given, otherwise from hopSize (seconds). */
+    static Error_t ComputeFrameTargets(std::vector<FrameTarget>& frames, const std::vector<MotionSegment>& segments,
+                                       int8_t transpose, float hopSize, Span<float> timeStamps = {});
+
+    /* Fret position of the segment at a (possibly fractional) frame */
+    static float Evaluate(const MotionSegment& segment, double fFrame);
+    /* Fret position change per frame of the segment at a (possibly fractional) frame */
+    static float GetSlope(const MotionSegment& segment, double fFrame);
+    /* Target and speed (frets per frame) of a point to point move that follows the segment from iFrame:
+     * the end of a ramp or the next turning point of an oscillation. Holds return a speed of 0. */
+    static float GetTarget(const MotionSegment& segment, size_t iFrame, float& fSpeed);
+
+private:
+    static void FillRests(std::vector<float>& track, Span<float> pitches);
+    static void FindExtrema(std::vector<size_t>& extrema, const std::vector<float>& track, float fHysteresis);
+    static bool FitOscillation(MotionSegment& segment, const std::vector<float>& track, const std::vector<size_t>& extrema,
+                               size_t iFirst, size_t iLast, float fTolerance);
+    static void CompileLinear(std::vector<MotionSegment>& segments, const std::vector<float>& track,
+                              size_t iStart, size_t iEnd, float fTolerance);
+};
+
+#endif //HATHAANI_TRAJECTORYCOMPILER_H
@@ -5,6 +5,7 @@
 #ifndef HATHAANI_UTIL_H
 #define HATHAANI_UTIL_H
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -12,10 +13,47 @@
 
 class Util {
 public:
+    // FretLength table: kFretTableResolution points per fret over [0, kFretTableMaxFret]
+    static const int kFretTableResolution = 64;
+    static const int kFretTableMaxFret = 24;
+    static const int kFretTableSize = kFretTableResolution * kFretTableMaxFret + 1;
+
+    /* Distance (mm) of a fret from the nut. Linear interpolation in a table, which is off from
+     * FretLengthExact by at most SCALE_LENGTH * (ln2 / 12)^2 / (8 * kFretTableResolution^2) = 3.4e-5 mm
+     * (0.0035 pulses) plus one float ulp (1.5e-5 mm) for the rounding of the entries and of the result,
+     * 3.6e-5 mm measured (FretTableTest). Frets outside the table use FretLengthExact. */
     static double FretLength(float fretNumber) {
+        float fIndex = fretNumber * kFretTableResolution;
+        if (!(fIndex >= 0 && fIndex < kFretTableSize - 1))  // also NaN
+            return FretLengthExact(fretNumber);
+
+        auto i = (int)fIndex;
+        float fFraction = fIndex - (float)i;
+        const float* pfLength = &s_fretTable.afLength[i];
+        return pfLength[0] + fFraction * (pfLength[1] - pfLength[0]);
+    }
+
+    static double FretLengthExact(float fretNumber) {
         return (SCALE_LENGTH - (SCALE_LENGTH / pow(2, (fretNumber / 12.f))));
     }
 
+    /* Change of FretLength per fret, SCALE_LENGTH * ln2 / 12 / 2^(fret / 12) is the remaining string length times ln2 / 12 */
+    static double FretLengthSlope(float fretNumber) {
+        return M_LN2 / 12.0 * (SCALE_LENGTH - FretLength(fretNumber));
+    }
+
+    /* Slide speed (rpm) for moving fretsPerSecond around fretNumber */
+    static double FretSpeedToRpm(float fretNumber, double fretsPerSecond) {
+        return fretsPerSecond * FretLengthSlope(fretNumber) * P2P_MULTIPLIER * 60 / ENCODER_INC_PER_TURN;
+    }
+
+    /* Profile velocity (rpm) for a slide towards fretNumber, SLIDE_PROFILE_VELOCITY when fretsPerSecond is 0 */
+    static unsigned long SlideVelocity(float fretNumber, float fretsPerSecond) {
+        if (fretsPerSecond <= 0)
+            return SLIDE_PROFILE_VELOCITY;
+        return std::clamp((unsigned long)std::lround(FretSpeedToRpm(fretNumber, fretsPerSecond)), 1ul, SLIDE_PROFILE_VELOCITY);
+    }
+
     static long PositionToPulse(double p, int direction = 1) {
         return (long)(direction * p * P2P_MULTIPLIER);
 //        return (long)(direction * p * 24000.0 / 220.0);
@@ -32,5 +70,16 @@ public:
         return kNoError;
 #endif
     }
+
+private:
+    struct FretTable {
+        float afLength[kFretTableSize];
+
+        FretTable() {
+            for (int i = 0; i < kFretTableSize; ++i)
+                afLength[i] = (float)FretLengthExact((float)i / kFretTableResolution);
+        }
+    };
+    inline static const FretTable s_fretTable {};
 };
 #endif //HATHAANI_UTIL_H
@@ -0,0 +1,57 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Time per call of Util::FretLength (table) and Util::FretLengthExact (pow) over random frets
+// within the table, and of fret2Position, which the trajectory compiler calls per frame.
+// Reports the best of several runs in ns per call.
+//
+//   FretTableBench
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Util.h"
+
+namespace {
+    const int kNumRuns = 15;
+    const int kNumFrets = 4096;
+
+    volatile double g_dSink;    // keeps the compiler from dropping the measured calls
+
+    template <class Fn>
+    double measure(Fn&& fn, const std::vector<float>& frets) {
+        double dBest = std::numeric_limits<double>::max();
+        for (int iRun = 0; iRun < kNumRuns; iRun++) {
+            double dSum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (float fFret : frets)
+                dSum += fn(fFret);
+            auto stop = std::chrono::steady_clock::now();
+            g_dSink = dSum;
+            dBest = std::min(dBest, std::chrono::duration<double, std::nano>(stop - start).count() / (double)frets.size());
+        }
+        return dBest;
+    }
+}
+
+int main() {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> fret(0, Util::kFretTableMaxFret);
+    std::vector<float> frets(kNumFrets);
+    for (float& fFret : frets)
+        fFret = fret(rng);
+
+    double dTableNs = measure([](float f) { return Util::FretLength(f); }, frets);
+    double dExactNs = measure([](float f) { return Util::FretLengthExact(f); }, frets);
+    double dPositionNs = measure([](float f) { return (double)Util::fret2Position(f); }, frets);
+
+    std::printf("  %-16s %8.2f ns\n", "FretLength", dTableNs);
+    std::printf("  %-16s %8.2f ns  %5.2fx\n", "FretLengthExact", dExactNs, dExactNs / dTableNs);
+    std::printf("  %-16s %8.2f ns\n", "fret2Position", dPositionNs);
+    return 0;
+}
@@ -0,0 +1,168 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Parse time and peak memory of PitchFileParser::parseJson (SAX) and of the DOM parser it replaced
+// (DomScoreParser.h), on every Examples/*.json and on a synthetic pretty printed score of about the
+// given size. Each parse runs in a forked process so that the peak RSS (wait4) belongs to that parse
+// alone; "idle" is the peak of a process that only forks and exits. Time is the best of several parses.
+//
+//   ParserBench <Examples directory> [synthetic score size in MB, default 100]
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DomScoreParser.h"
+#include "PitchFileParser.h"
+
+namespace {
+    enum Parser {
+        kIdle,
+        kDom,
+        kSax
+    };
+
+    struct Measurement {
+        bool bOk = false;
+        double dMs = 0;
+        long iPeakRssKb = 0;
+        size_t iNumFrames = 0;
+    };
+
+    Error_t parse(Parser eParser, const std::string& filePath, size_t& iNumFrames) {
+        std::vector<float> pitches, amplitude, timeStamps;
+        std::vector<size_t> bowChanges;
+        float hopSize;
+        Error_t err = kNoError;
+        if (eParser == kDom) {
+            err = parseScoreDom(filePath, pitches, bowChanges, amplitude, hopSize, timeStamps);
+        } else if (eParser == kSax) {
+            PitchFileParser parser(filePath);
+            err = parser.parseJson(pitches, bowChanges, amplitude, hopSize, timeStamps);
+        }
+        iNumFrames = pitches.size();
+        return err;
+    }
+
+    Measurement measure(Parser eParser, const std::string& filePath, int iNumRuns) {
+        Measurement result;
+        int aiPipe[2];
+        if (pipe(aiPipe) != 0)
+            return result;
+
+        pid_t pid = fork();
+        if (pid < 0)
+            return result;
+
+        if (pid == 0) {
+            close(aiPipe[0]);
+            Measurement child;
+            child.dMs = std::numeric_limits<double>::max();
+            child.bOk = true;
+            for (int iRun = 0; iRun < iNumRuns; iRun++) {
+                auto start = std::chrono::steady_clock::now();
+                child.bOk &= (parse(eParser, filePath, child.iNumFrames) == kNoError);
+                auto stop = std::chrono::steady_clock::now();
+                child.dMs = std::min(child.dMs, std::chrono::duration<double, std::milli>(stop - start).count());
+            }
+            bool bWritten = (write(aiPipe[1], &child, sizeof(child)) == sizeof(child));
+            _exit(bWritten ? 0 : 1);
+        }
+
+        close(aiPipe[1]);
+        bool bRead = (read(aiPipe[0], &result, sizeof(result)) == sizeof(result));
+        close(aiPipe[0]);
+
+        int iStatus;
+        struct rusage usage = {};
+        wait4(pid, &iStatus, 0, &usage);
+        result.bOk &= bRead && WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == 0;
+        result.iPeakRssKb = usage.ru_maxrss;
+        return result;
+    }
+
+    /* pretty printed like the bundled scores: pitch and amplitude one value per line, a bow change every ~100 frames */
+    std::string writeSyntheticScore(size_t iSizeMb) {
+        auto path = std::filesystem::temp_directory_path() / "ParserBench_synthetic.json";
+        std::FILE* pFile = std::fopen(path.c_str(), "w");
+        if (!pFile)
+            return "";
+
+        const size_t kBytesPerFrame = 19;
+        size_t iNumFrames = iSizeMb * 1000000 / kBytesPerFrame;
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> pitch(0, 120), amplitude(0, 99);
+
+        std::fprintf(pFile, "{\n  \"pitch\": [\n");
+        for (size_t i = 0; i < iNumFrames; i++) {
+            int iPitch = pitch(rng);
+            std::fprintf(pFile, "    %d.%d%s\n", iPitch / 10, iPitch % 10, (i + 1 < iNumFrames) ? "," : "");
+        }
+        std::fprintf(pFile, "  ],\n  \"bow\": [\n");
+        for (size_t i = 100; i < iNumFrames; i += 100)
+            std::fprintf(pFile, "    %zu%s\n", i, (i + 100 < iNumFrames) ? "," : "");
+        std::fprintf(pFile, "  ],\n  \"amplitude\": [\n");
+        for (size_t i = 0; i < iNumFrames; i++)
+            std::fprintf(pFile, "    0.%02d%s\n", amplitude(rng), (i + 1 < iNumFrames) ? "," : "");
+        std::fprintf(pFile, "  ]\n}\n");
+        std::fclose(pFile);
+        return path.string();
+    }
+
+    void print(const std::string& name, const Measurement& dom, const Measurement& sax) {
+        std::printf("%-22s %9zu  %10.2f %9.1f  %10.2f %9.1f%s\n", name.c_str(), sax.iNumFrames, dom.dMs,
+                    dom.iPeakRssKb / 1024., sax.dMs, sax.iPeakRssKb / 1024., (dom.bOk && sax.bOk) ? "" : "  FAIL");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long iSizeMb = (argc > 2) ? std::atol(argv[2]) : 100;
+    if (argc < 2 || argc > 3 || iSizeMb <= 0) {
+        std::fprintf(stderr, "usage: %s <Examples directory> [synthetic score size in MB]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> files;
+    for (auto& entry : std::filesystem::directory_iterator(argv[1])) {
+        if (entry.path().extension() == ".json")
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+
+    auto idle = measure(kIdle, "", 1);
+    std::printf("idle process peak RSS %.1f MB\n", idle.iPeakRssKb / 1024.);
+    std::printf("%-22s %9s  %10s %9s  %10s %9s\n", "score", "frames", "DOM ms", "DOM MB", "SAX ms", "SAX MB");
+
+    bool bOk = idle.bOk;
+    for (auto& path : files) {
+        auto dom = measure(kDom, path.string(), 50);
+        auto sax = measure(kSax, path.string(), 50);
+        print(path.filename().string(), dom, sax);
+        bOk &= dom.bOk && sax.bOk;
+    }
+
+    auto syntheticPath = writeSyntheticScore(iSizeMb);
+    if (syntheticPath.empty()) {
+        std::fprintf(stderr, "cannot write the synthetic score\n");
+        return 1;
+    }
+    auto dom = measure(kDom, syntheticPath, 3);
+    auto sax = measure(kSax, syntheticPath, 3);
+    print("synthetic " + std::to_string(std::filesystem::file_size(syntheticPath) / 1000000) + " MB", dom, sax);
+    bOk &= dom.bOk && sax.bOk;
+    std::filesystem::remove(syntheticPath);
+
+    return bOk ? 0 : 1;
+}
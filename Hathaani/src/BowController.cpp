@@ -6,12 +6,13 @@
 
 BowController::BowController() : m_bInitialized(false),
                                  m_commHandler(nullptr),
-                                 m_pPortHandler(nullptr),
+                                 m_pDxlBus(nullptr),
                                  m_bowingState(Stopped),
                                  m_iBowSpeed(0), m_fBowPressure(0),
                                  m_currentDirection(Bow::Down), m_currentBowPitch(MIN_PITCH),
                                  m_currentAmplitude(0), m_currentSurge(0),
-                                 m_piRTPosition(nullptr), m_wheelController(BOW_EPOS4_USB, 2) {}
+                                 m_piRTPosition(nullptr), m_wheelController(BOW_EPOS4_USB, 2),
+                                 m_pPitchDxl(nullptr), m_pYawDxl(nullptr), m_pRollDxl(nullptr) {}
 
 
 BowController::~BowController()
@@ -46,47 +47,42 @@ Error_t BowController::Destroy(BowController *&pCInstance) {
 #endif
 }
 
-Error_t BowController::Init(CommHandler* commHandler, PortHandler& portHandler, int* RTPosition) {
+Error_t BowController::Init(CommHandler* commHandler, DynamixelBus& dxlBus, int* RTPosition) {
     auto err = Reset();
     if (err != kNoError)
         return err;
 
-    m_pPortHandler = &portHandler;
-    auto* packetHandler = PortHandler::getPacketHandler();
+    m_pDxlBus = &dxlBus;
+    auto& portHandler = m_pDxlBus->getPortHandler();
+    auto* packetHandler = &m_pDxlBus->getPacketHandler();
 
-    m_pPitchDxl = new Dynamixel(2, *m_pPortHandler, *packetHandler);
+    m_pPitchDxl = new Dynamixel(2, portHandler, *packetHandler);
     m_pPitchDxl->operatingMode(OperatingMode::PositionControl);
     if (m_pPitchDxl->torque() != 0) {
         LOG_ERROR("Cannot set torque on pitch dxl");
         return kSetValueError;
     }
 
-    if (m_pPitchDxl->moveToPosition(180.f) != SUCCESS) {
-        LOG_ERROR("Cannot set torque on pitch dxl");
-        return kSetValueError;
-    }
-
-    m_pRollDxl = new Dynamixel(4, *m_pPortHandler, *packetHandler);
+    m_pRollDxl = new Dynamixel(4, portHandler, *packetHandler);
     m_pRollDxl->operatingMode(OperatingMode::PositionControl);
     if (m_pRollDxl->torque() != 0) {
         LOG_ERROR("Cannot set torque on Roll dxl");
         return kSetValueError;
     }
 
-    if (m_pRollDxl->moveToPosition(180.f) != SUCCESS) {
-        LOG_ERROR("Cannot set torque on pitch dxl");
-        return kSetValueError;
-    }
-
-    m_pYawDxl = new Dynamixel(3, *m_pPortHandler, *packetHandler);
+    m_pYawDxl = new Dynamixel(3, portHandler, *packetHandler);
     m_pYawDxl->operatingMode(OperatingMode::PositionControl);
     if (m_pYawDxl->torque() != 0) {
         LOG_ERROR("Cannot set torque on Yaw dxl");
         return kSetValueError;
     }
 
-    if (m_pYawDxl->moveToPosition(140.f) != SUCCESS) {
-        LOG_ERROR("Cannot set torque on pitch dxl");
+    // Home all bow joints with a single packet
+    auto ticket = m_pDxlBus->write({DynamixelBus::goalPosition(*m_pPitchDxl, 180.f),
+                                    DynamixelBus::goalPosition(*m_pRollDxl, 180.f),
+                                    DynamixelBus::goalPosition(*m_pYawDxl, 140.f)});
+    if (m_pDxlBus->waitUntilSent(ticket, std::chrono::milliseconds(DXL_SEND_TIMEOUT_MS)) != SUCCESS) {
+        LOG_ERROR("Sending bow home positions failed");
         return kSetValueError;
     }
 
@@ -131,10 +127,8 @@ Error_t BowController::setPressure(float fAmplitude) {
     m_fBowPressure = fAmplitude;
     auto fAngle = transformPressure(m_fBowPressure);
 //    std::cout << fAmplitude << " " << fAngle << std::endl;
-    if (m_pPitchDxl->moveToPosition(fAngle) != SUCCESS) {
-        LOG_ERROR("Pitch dxl Move to position error");
-        return kSetValueError;
-    }
+    // Queued on the bus thread, a newer pressure replaces one that has not been sent yet
+    m_pDxlBus->setGoalPosition(*m_pPitchDxl, fAngle);
 #endif
     return kNoError;
 }
@@ -332,9 +326,6 @@ Error_t BowController::setString(BowController::String str) {
             break;
     }
 
-    if (m_pRollDxl->moveToPosition(angle) != SUCCESS) {
-        LOG_ERROR("Cannot set torque on pitch dxl");
-        return kSetValueError;
-    }
+    m_pDxlBus->setGoalPosition(*m_pRollDxl, angle);
     return kNoError;
 }
@@ -55,17 +55,7 @@ Error_t EposController::init(OperationMode mode)
     }
 
     m_operationMode = mode;
-    switch (m_operationMode) {
-        case Position:
-            ActivatePositionMode();
-            break;
-        case ProfilePosition:
-            ActivateProfilePositionMode();
-            break;
-        case ProfileVelocity:
-            ActivateProfileVelocityMode();
-            break;
-    }
+    ActivateOperationMode(m_operationMode);
 
 #endif //__arm__
     return kNoError;
@@ -206,6 +196,46 @@ Error_t EposController::ActivateProfileVelocityMode()
     return err;
 }
 
+Error_t EposController::ActivateInterpolatedPositionMode()
+{
+    // the PVT points carry positions and rpm scaled with ENCODER_INC_PER_TURN
+    Error_t err = CheckEncoderIncPerTurn();
+    if (err != kNoError)
+        return err;
+#ifdef __arm__
+    unsigned int errorCode = 0;
+    if (VCS_ActivateInterpolatedPositionMode(pKeyHandle, m_iNodeID, &errorCode) == 0) {
+        err = kSetValueError;
+        std::cerr << "VCS_ActivateInterpolatedPositionMode" << std::endl;
+        return err;
+    }
+
+    if (VCS_ClearIpmBuffer(pKeyHandle, m_iNodeID, &errorCode) == 0) {
+        err = kSetValueError;
+        std::cerr << "VCS_ClearIpmBuffer" << std::endl;
+        return err;
+    }
+
+    m_operationMode = InterpolatedPosition;
+#endif // __arm__
+    return err;
+}
+
+Error_t EposController::ActivateOperationMode(OperationMode mode)
+{
+    switch (mode) {
+        case Position:
+            return ActivatePositionMode();
+        case ProfilePosition:
+            return ActivateProfilePositionMode();
+        case ProfileVelocity:
+            return ActivateProfileVelocityMode();
+        case InterpolatedPosition:
+            return ActivateInterpolatedPositionMode();
+    }
+    return kFunctionInvalidArgsError;
+}
+
 Error_t EposController::SetPositionProfile(unsigned long ulVelocity, unsigned long ulAcc)
 {
     Error_t err = kNoError;
@@ -266,6 +296,8 @@ Error_t EposController::moveToPositionl(long targetPos)
                 return kSetValueError;
             }
         }
+    } else {
+        return kFunctionIllegalCallError;
     }
     return kNoError;
 #endif // __arm__
@@ -344,6 +376,48 @@ Error_t EposController::MoveWithVelocity(long lVelocity)
     return kNoError;
 }
 
+Error_t EposController::GetEncoderIncPerTurn(int& iIncPerTurn)
+{
+    iIncPerTurn = ENCODER_INC_PER_TURN;
+#ifdef __arm__
+    unsigned int errorCode = 0;
+    unsigned short usSensorType = 0;
+    if (VCS_GetSensorType(pKeyHandle, m_iNodeID, &usSensorType, &errorCode) == 0) {
+        std::cerr << "VCS_GetSensorType" << std::endl;
+        return kGetValueError;
+    }
+
+    if (usSensorType != ST_INC_ENCODER_3CHANNEL && usSensorType != ST_INC_ENCODER_2CHANNEL) {
+        std::cerr << "Sensor type " << usSensorType << " is not the first incremental encoder, its resolution cannot be read" << std::endl;
+        return kGetValueError;
+    }
+
+    unsigned int uiResolution = 0;
+    int iInvertedPolarity = 0;
+    if (VCS_GetIncEncoderParameter(pKeyHandle, m_iNodeID, &uiResolution, &iInvertedPolarity, &errorCode) == 0) {
+        std::cerr << "VCS_GetIncEncoderParameter" << std::endl;
+        return kGetValueError;
+    }
+
+    // the resolution is in pulses per turn, the drive counts all four edges
+    iIncPerTurn = 4 * (int)uiResolution;
+#endif // __arm__
+    return kNoError;
+}
+
+Error_t EposController::CheckEncoderIncPerTurn()
+{
+    int iIncPerTurn = 0;
+    auto err = GetEncoderIncPerTurn(iIncPerTurn);
+    if (err != kNoError)
+        return err;
+    if (iIncPerTurn != ENCODER_INC_PER_TURN) {
+        std::cerr << "Encoder has " << iIncPerTurn << " increments per turn, ENCODER_INC_PER_TURN is " << ENCODER_INC_PER_TURN << std::endl;
+        return kGetValueError;
+    }
+    return kNoError;
+}
+
 Error_t EposController::Halt()
 {
 #ifdef __arm__
@@ -355,3 +429,75 @@ Error_t EposController::Halt()
 #endif // __arm__
     return kNoError;
 }
+
+Error_t EposController::AddPvtPoint(long lPosition, long lVelocity, uint8_t uiTimeMs)
+{
+#ifdef __arm__
+    if (m_operationMode != InterpolatedPosition)
+        return kFunctionIllegalCallError;
+
+    unsigned int errorCode = 0;
+    if (VCS_AddPvtValueToIpmBuffer(pKeyHandle, m_iNodeID, lPosition*m_iEncoderDirection, lVelocity*m_iEncoderDirection, uiTimeMs, &errorCode) == 0) {
+        std::cerr << "VCS_AddPvtValueToIpmBuffer" << std::endl;
+        return kSetValueError;
+    }
+#endif // __arm__
+    return kNoError;
+}
+
+Error_t EposController::GetFreeIpmBufferSize(unsigned int& uiBufferSize)
+{
+    uiBufferSize = 0;
+#ifdef __arm__
+    unsigned int errorCode = 0;
+    if (VCS_GetFreeIpmBufferSize(pKeyHandle, m_iNodeID, &uiBufferSize, &errorCode) == 0) {
+        std::cerr << "VCS_GetFreeIpmBufferSize" << std::endl;
+        return kGetValueError;
+    }
+#endif // __arm__
+    return kNoError;
+}
+
+Error_t EposController::GetIpmStatus(IpmStatus& status)
+{
+    status = IpmStatus();
+#ifdef __arm__
+    unsigned int errorCode = 0;
+    int iRunning = 0, iUnderflowWarning = 0, iOverflowWarning = 0, iVelocityWarning = 0, iAccelerationWarning = 0;
+    int iUnderflowError = 0, iOverflowError = 0, iVelocityError = 0, iAccelerationError = 0;
+    if (VCS_GetIpmStatus(pKeyHandle, m_iNodeID, &iRunning, &iUnderflowWarning, &iOverflowWarning, &iVelocityWarning, &iAccelerationWarning,
+                         &iUnderflowError, &iOverflowError, &iVelocityError, &iAccelerationError, &errorCode) == 0) {
+        std::cerr << "VCS_GetIpmStatus" << std::endl;
+        return kGetValueError;
+    }
+
+    status.bTrajectoryRunning = iRunning;
+    status.bUnderflowWarning = iUnderflowWarning;
+    status.bError = iUnderflowError || iOverflowError || iVelocityError || iAccelerationError;
+#endif // __arm__
+    return kNoError;
+}
+
+Error_t EposController::StartIpmTrajectory()
+{
+#ifdef __arm__
+    unsigned int errorCode = 0;
+    if (VCS_StartIpmTrajectory(pKeyHandle, m_iNodeID, &errorCode) == 0) {
+        std::cerr << "VCS_StartIpmTrajectory" << std::endl;
+        return kSetValueError;
+    }
+#endif // __arm__
+    return kNoError;
+}
+
+Error_t EposController::StopIpmTrajectory()
+{
+#ifdef __arm__
+    unsigned int errorCode = 0;
+    if (VCS_StopIpmTrajectory(pKeyHandle, m_iNodeID, &errorCode) == 0) {
+        std::cerr << "VCS_StopIpmTrajectory" << std::endl;
+        return kSetValueError;
+    }
+#endif // __arm__
+    return kNoError;
+}
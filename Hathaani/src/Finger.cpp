@@ -4,16 +4,17 @@
 
 #include "Finger.h"
 
-Finger::Finger(float D) : m_fD(D), m_pPortHandler(nullptr) {
+Finger::Finger(float D) : m_fD(D), m_pDxlBus(nullptr) {
     m_dxl.reserve(NUM_ACTUATORS);
+    initGrid();
 }
 
 Finger::~Finger() {
     reset();
 }
 
-Error_t Finger::moveToPosition(float x, float y, bool bWait) {
-    auto ret = calcIK(x, y);
+Error_t Finger::moveToPosition(float x, float y, bool bWait, bool bInterpolate) {
+    auto ret = bInterpolate ? calcIKInterpolated(x, y) : calcIK(x, y);
     if (ret != SUCCESS)
         return ret;
 
@@ -25,6 +26,58 @@ Error_t Finger::moveToPosition(float x, float y, bool bWait) {
 }
 
 Error_t Finger::calcIK(float x, float y) {
+    for (const auto& solution : m_ikCache) {
+        if (solution.x == x && solution.y == y) {
+            _theta1 = solution.theta1;
+            _theta2 = solution.theta2;
+            return kNoError;
+        }
+    }
+
+    auto err = solveIK(x, y, _theta1, _theta2);
+    if (err != kNoError)
+        return err;
+
+    m_ikCache[m_iNextCacheEntry] = {x, y, _theta1, _theta2};
+    m_iNextCacheEntry = (m_iNextCacheEntry + 1) % kIKCacheSize;
+    return kNoError;
+}
+
+Error_t Finger::calcIKInterpolated(float x, float y) {
+    float fX = (x - kGridMinX) / kGridStep;
+    float fY = (y - kGridMinY) / kGridStep;
+    if (!(fX >= 0 && fX < kGridNumX - 1 && fY >= 0 && fY < kGridNumY - 1))
+        return calcIK(x, y);
+
+    auto i = (int)fX;
+    auto k = (int)fY;
+    if (!m_abGridValid[k][i] || !m_abGridValid[k][i + 1] || !m_abGridValid[k + 1][i] || !m_abGridValid[k + 1][i + 1])
+        return calcIK(x, y);
+
+    fX -= (float)i;
+    fY -= (float)k;
+    float afTheta[2];
+    for (int n = 0; n < 2; ++n) {
+        float fLow = m_afGrid[k][i][n] + fX * (m_afGrid[k][i + 1][n] - m_afGrid[k][i][n]);
+        float fHigh = m_afGrid[k + 1][i][n] + fX * (m_afGrid[k + 1][i + 1][n] - m_afGrid[k + 1][i][n]);
+        afTheta[n] = fLow + fY * (fHigh - fLow);
+    }
+
+    _theta1 = afTheta[0];
+    _theta2 = afTheta[1];
+    return kNoError;
+}
+
+void Finger::initGrid() {
+    for (int k = 0; k < kGridNumY; ++k) {
+        for (int i = 0; i < kGridNumX; ++i) {
+            auto& afTheta = m_afGrid[k][i];
+            m_abGridValid[k][i] = (solveIK(kGridMinX + (float)i * kGridStep, kGridMinY + (float)k * kGridStep, afTheta[0], afTheta[1]) == kNoError);
+        }
+    }
+}
+
+Error_t Finger::solveIK(float x, float y, float& fTheta1, float& fTheta2) {
     auto j = m_links;
 
     float phi = std::atan2(y, -x);
@@ -36,9 +89,9 @@ Error_t Finger::calcIK(float x, float y) {
         return kNaNError;
     float alpha = std::acos(temp);
 
-    _theta1 = M_PI - phi - alpha;
+    float theta1 = M_PI - phi - alpha;
 
-    j[l14].update(0, 0, _theta1);
+    j[l14].update(0, 0, theta1);
     temp = (sq_L01 - sq(j[l14].l) - sq(j[l04].l)) / (2 * j[l04].l * j[l14].l);
     if (std::abs(temp) > 1)
         return kNaNError;
@@ -47,7 +100,7 @@ Error_t Finger::calcIK(float x, float y) {
     auto x1 = j[l14].x1;
     auto y1 = j[l14].y1;
 
-    j[l04].update(x1, y1, theta4 + _theta1);
+    j[l04].update(x1, y1, theta4 + theta1);
 
     float m = j[l04].m;
     float x0 = j[l04].x;
@@ -74,22 +127,25 @@ Error_t Finger::calcIK(float x, float y) {
 
     float phi2 = std::acos(temp);
 
-    _theta2 = theta5 + phi2; // Change the sign to invert the inner joint
+    float theta2 = theta5 + phi2; // Change the sign to invert the inner joint
 
-    j[l23].update(-m_fD, 0, _theta2);
+    j[l23].update(-m_fD, 0, theta2);
     auto x3 = j[l23].x1;
     auto y3 = j[l23].y1;
     float phi5 = M_PI - std::atan2(y5 - y3, -x5 + x3);
     j[l35].update(x3, y3, phi5);
 
-    _theta1 = M_PI_2 - _theta1;
-    _theta2 = M_PI_2 - _theta2;
+    theta1 = M_PI_2 - theta1;
+    theta2 = M_PI_2 - theta2;
 
-    if (std::isnan(_theta1) || std::isnan(_theta2)) {
-        std::cout<< _theta1 * 180.f/M_PI << " " << _theta2 * 180.f/M_PI << std::endl;
+    if (std::isnan(theta1) || std::isnan(theta2)) {
+        std::cout<< theta1 * 180.f/M_PI << " " << theta2 * 180.f/M_PI << std::endl;
         return kNaNError;
     }
 
+    // only a complete solution is handed out, a failed one leaves the caller's angles as they were
+    fTheta1 = theta1;
+    fTheta2 = theta2;
     return kNoError;
 }
 
@@ -98,16 +154,12 @@ void Finger::getDriveAngles(float &angle0, float &angle1) const {
     angle1 = _theta2;
 }
 
-Error_t Finger::init(PortHandler& portHandler) {
-    m_pPortHandler = &portHandler;
-
-    auto* packetHandler = PortHandler::getPacketHandler();
-    if (!packetHandler) {
-        return kNotInitializedError;
-    }
+Error_t Finger::init(DynamixelBus& bus) {
+    m_pDxlBus = &bus;
 
+    m_dxl.clear();
     for (int i=0; i<NUM_ACTUATORS; ++i) {
-        m_dxl[i] = Dynamixel(i, *m_pPortHandler, *packetHandler);
+        m_dxl.emplace_back(i, m_pDxlBus->getPortHandler(), m_pDxlBus->getPacketHandler());
         m_dxl[i].operatingMode(OperatingMode::CurrentBasedPositionControl);
         m_dxl[i].setGoalCurrent(MAX_CURRENT);
 
@@ -115,14 +167,17 @@ Error_t Finger::init(PortHandler& portHandler) {
             LOG_ERROR("Cannot set torque on {}", i);
             return kSetValueError;
         }
+
+        if (m_pDxlBus->addToPoll(m_dxl[i]) != SUCCESS)
+            return kNotInitializedError;
     }
 
     return kNoError;
 }
 
 Error_t Finger::reset() {
-    for (int i=0; i<NUM_ACTUATORS; ++i)
-        m_dxl[i].torque(false);
+    for (auto& dxl : m_dxl)
+        dxl.torque(false);
 
     return kNoError;
 }
@@ -131,17 +186,38 @@ Error_t Finger::moveJoints(float* pfTheta, bool bWait, bool isRadian) {
     if (pfTheta == nullptr)
         return kFunctionIllegalCallError;
 
-    for (int i=0; i<NUM_ACTUATORS; ++i) {
-        auto ret = m_dxl[i].moveToPosition(pfTheta[i], isRadian);
-        if (ret != SUCCESS)
+    if (!m_pDxlBus)
+        return kNotInitializedError;
+
+    // Both joints go out in one packet so they start moving together
+    std::vector<DynamixelCommand> commands;
+    for (int i=0; i<NUM_ACTUATORS; ++i)
+        commands.push_back(DynamixelBus::goalPosition(m_dxl[i], pfTheta[i], isRadian));
+    auto ticket = m_pDxlBus->write(commands);
+
+    if (bWait) {
+        if (m_pDxlBus->waitUntilSent(ticket, std::chrono::milliseconds(DXL_SEND_TIMEOUT_MS)) != SUCCESS) {
+            LOG_ERROR("Sending finger joint positions failed");
             return kSetValueError;
+        }
+        return wait();
     }
 
-    if (bWait) wait();
-
     return kNoError;
 }
 
-void Finger::wait() {
-    while (m_dxl[0].isMoving() || m_dxl[1].isMoving());
+Error_t Finger::wait(std::chrono::milliseconds timeout) {
+    if (!m_pDxlBus)
+        return kNotInitializedError;
+
+    std::vector<int> ids;
+    for (const auto& dxl : m_dxl)
+        ids.push_back(dxl.getId());
+
+    if (!m_pDxlBus->waitUntilStopped(ids, timeout)) {
+        LOG_WARN("Finger still moving after {} ms", timeout.count());
+        return kTimeoutError;
+    }
+
+    return kNoError;
 }
@@ -5,7 +5,7 @@
 #include "FingerController.h"
 
 FingerController::FingerController(CommHandler* pCommHandler,
-                                   PortHandler& portHandler):  EposController(FINGER_EPOS4_USB, 1),
+                                   DynamixelBus& dxlBus):  EposController(FINGER_EPOS4_USB, 1),
                                                                 prevSentValue(0),
                                                                 m_bInitialized(false),
                                                                 currentState(REST),
@@ -18,7 +18,13 @@ FingerController::FingerController(CommHandler* pCommHandler,
         LOG_ERROR("Epos Controller Init failed.");
         return;
     }
-    err = m_finger.init(portHandler);
+
+    // Slide velocities are converted to rpm with ENCODER_INC_PER_TURN, so a different encoder scales them.
+    // Profile position still works then, only the interpolated position mode refuses to start.
+    if (CheckEncoderIncPerTurn() != kNoError)
+        LOG_WARN("Finger encoder does not match ENCODER_INC_PER_TURN ({}), slide speeds will be off and IPM is disabled.", ENCODER_INC_PER_TURN);
+
+    err = m_finger.init(dxlBus);
 
     m_bInitialized = true;
 }
@@ -88,11 +94,16 @@ Error_t FingerController::setCurrentState(FingerController::State c_state, bool
     currentState = c_state;
     if (bMove) {
         auto pos = GetPosition(currentState);
-        return m_finger.moveToPosition(-153, pos, false);
+        return m_finger.moveToPosition(kFingerX, pos, false);
     }
     return kNoError;
 }
 
+Error_t FingerController::setFingerHeight(float fHeight) {
+    currentState = HEIGHT;
+    return m_finger.moveToPosition(kFingerX, fHeight, false, true);
+}
+
 Error_t FingerController::moveToPosition(float fFretPosition)
 {
     return moveToPositionl(Util::fret2Position(fFretPosition));
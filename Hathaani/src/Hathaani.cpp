@@ -4,6 +4,8 @@
 
 #include "Hathaani.h"
 
+#include <algorithm>
+
 Hathaani::Hathaani(): m_iRTPosition(0),
                         ulErrorCode(0),
                         m_bStopPositionUpdates(false),
@@ -33,12 +35,16 @@ Hathaani::~Hathaani() {
     delete m_pCommHandler;
 }
 
-Error_t Hathaani::init(bool shouldHome, bool usePitchCorrection) {
+Error_t Hathaani::init(bool shouldHome, bool usePitchCorrection, int trackingRateHz) {
     Error_t err;
 //    BOOL oIsFault = 0;
     m_bShouldHome = shouldHome;
     m_bUsePitchCorrection = usePitchCorrection;
 
+    if (trackingRateHz <= 0)
+        return kFunctionInvalidArgsError;
+    m_iTrackingRateHz = trackingRateHz;
+
     //init communication handlers
     m_pCommHandler = new CommHandler(CommHandler::I2C);
     if (!m_pCommHandler->isInitialized()) {
@@ -46,9 +52,9 @@ Error_t Hathaani::init(bool shouldHome, bool usePitchCorrection) {
         LOG_ERROR("Commhandler init Error");
         return err;
     }
-    auto* pPortHandler = m_pCommHandler->getDxlPortHandler();
+    auto* pDxlBus = m_pCommHandler->getDxlBus();
 
-    m_pFingerController = new FingerController(m_pCommHandler, *pPortHandler);
+    m_pFingerController = new FingerController(m_pCommHandler, *pDxlBus);
     if (!m_pFingerController->isInitialized()) {
         err = kNotInitializedError;
         LOG_ERROR("FingerInitError");
@@ -68,7 +74,7 @@ Error_t Hathaani::init(bool shouldHome, bool usePitchCorrection) {
         return err;
     }
 
-    if ((err = m_pBowController->Init(m_pCommHandler, *pPortHandler, &m_iRTPosition)) != kNoError) {
+    if ((err = m_pBowController->Init(m_pCommHandler, *pDxlBus, &m_iRTPosition)) != kNoError) {
         LOG_ERROR("Bow controller Init Error.");
         return err;
     }
@@ -92,21 +98,70 @@ void Hathaani::LogError(const string &functionName, Error_t p_lResult, unsigned
 }
 
 Error_t Hathaani::UpdateTargetPosition() {
-    long targetPosition = Util::fret2Position(m_fFretPosition);
+    auto setpoint = m_setpointChannel.read();
+    // Targets come converted to pulses, only a pitch correction has to go through the conversion here
+    long targetPosition = setpoint.lSlideTarget;
+    auto ulVelocity = setpoint.ulSlideVelocity;
+    float fCorrection = m_fPitchCorrection;
+    if (fCorrection != 0) {
+        float fTarget = setpoint.fSlideTarget + fCorrection;
+        targetPosition = Util::fret2Position(fTarget);
+        ulVelocity = Util::SlideVelocity(fTarget, setpoint.fSlideSpeed);
+    }
 //    std::cout << targetPosition << std::endl;
 //    return kNoError;
-    return m_pFingerController->moveToPositionl(targetPosition);
+    if (targetPosition == m_lLastTargetPosition) {
+        ++m_iSuppressedWrites;
+        return kNoError;
+    }
+
+    // Glides and oscillations are sent as one move at the speed of the segment instead of a target per frame
+    Error_t err;
+    if (ulVelocity != m_ulLastProfileVelocity) {
+        if ((err = m_pFingerController->SetPositionProfile(ulVelocity, SLIDE_PROFILE_ACCELERATION)) != kNoError)
+            return err;
+        m_ulLastProfileVelocity = ulVelocity;
+    }
+
+    err = m_pFingerController->moveToPositionl(targetPosition);
+    if (err == kNoError) {
+        m_lLastTargetPosition = targetPosition;
+        ++m_iPositionWrites;
+    }
+    return err;
 }
 
 void Hathaani::TrackTargetPosition() {
+    const auto period = std::chrono::microseconds(1000000 / m_iTrackingRateHz);
+    auto nextUpdate = std::chrono::steady_clock::now();
+    int iNumFailedUpdates = 0;
     while (!m_bStopPositionUpdates)
     {
-//            auto x = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_iTimeInterval);
-        if (UpdateTargetPosition() != kNoError)
-            break;
-//            std::this_thread::sleep_until(x);
-//            cout << GetPosition() << " " << ConvertToTargetPosition(m_pfFretPosition) << endl;
+        bool bIpm;
+        auto err = m_ipmTrajectory.Track([this] { return UpdateTargetPosition(); }, bIpm);
+        // The drive follows the trajectory on its own, the slide is not where the last target was afterwards
+        if (bIpm)
+            m_lLastTargetPosition = -1;
+
+        // A failed write is retried on the next update (the last target is only taken on success), so keep
+        // tracking and only report the first failure of a run and the recovery
+        if (err != kNoError) {
+            if (iNumFailedUpdates++ == 0)
+                LOG_ERROR("Position tracking update failed: {}", CUtil::GetErrorString(err));
+        } else if (iNumFailedUpdates > 0) {
+            LOG_WARN("Position tracking recovered after {} failed updates", iNumFailedUpdates);
+            iNumFailedUpdates = 0;
+        }
+
+        // Don't burst to catch up after an overrun, just keep the period from here on
+        nextUpdate = std::max(nextUpdate + period, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(nextUpdate);
     }
+    LOG_INFO("Position tracking: {} writes sent, {} suppressed", m_iPositionWrites.load(), m_iSuppressedWrites.load());
+}
+
+size_t Hathaani::getNumSuppressedWrites() const {
+    return m_iSuppressedWrites;
 }
 
 //Error_t Hathaani::Perform(const std::vector<float>& pitches, const std::vector<size_t>& bowChange, float amplitude, int8_t transpose) {
@@ -152,10 +207,71 @@ void Hathaani::TrackTargetPosition() {
 //    return m_pFingerController->Rest();
 //}
 
-Error_t Hathaani::Perform(const vector<float> &pitches, const vector<size_t> &bowChange, const vector<float> &amplitude, float maxAmplitude, int8_t transpose)
+Error_t Hathaani::Perform(const vector<float> &pitches, const vector<size_t> &bowChange, const vector<float> &amplitude, float maxAmplitude, int8_t transpose,
+                          float hopSize, const vector<float> &timeStamps)
+{
+    std::vector<uint8_t> bowChangeFlags;
+    Score::FlagBowChanges(bowChangeFlags, bowChange, pitches.size());
+
+    Score score;
+    score.pitches = pitches;
+    score.amplitude = amplitude;
+    score.bowChange = bowChangeFlags;
+    score.timeStamps = timeStamps;
+    score.hopSize = hopSize;
+    return Perform(score, maxAmplitude, transpose);
+}
+
+Error_t Hathaani::Perform(const Score& score, float maxAmplitude, int8_t transpose)
+{
+    ScoreTrajectory trajectory;
+    auto err = CompileTrajectory(trajectory, score, transpose, m_operationMode == EposController::InterpolatedPosition);
+    if (err != kNoError)
+        return err;
+
+    return Perform(score, trajectory, maxAmplitude, transpose);
+}
+
+Error_t Hathaani::CompileTrajectory(ScoreTrajectory& trajectory, const Score& score, int8_t transpose, bool bComputePvt)
+{
+    auto err = TrajectoryCompiler::Compile(trajectory.segments, score.pitches, score.hopSize);
+    if (err != kNoError)
+        return err;
+    LOG_INFO("Compiled {} frames into {} motion segments", score.pitches.size(), trajectory.segments.size());
+
+    trajectory.transpose = transpose;
+    err = TrajectoryCompiler::ComputeFrameTargets(trajectory.frames, trajectory.segments, transpose, score.hopSize, score.timeStamps);
+    if (err != kNoError)
+        return err;
+
+    trajectory.pvtPoints.clear();
+    if (bComputePvt)
+        return IpmTrajectory::Compute(trajectory.pvtPoints, trajectory.segments, transpose, score.hopSize, score.timeStamps);
+
+    return kNoError;
+}
+
+Error_t Hathaani::Perform(const Score& score, const ScoreTrajectory& trajectory, float maxAmplitude, int8_t transpose)
 {
+    const auto& pitches = score.pitches;
+    const auto& amplitude = score.amplitude;
+    const auto& timeStamps = score.timeStamps;
+    const auto& frames = trajectory.frames;
+    float hopSize = score.hopSize;
+    if (amplitude.size() != pitches.size() || score.bowChange.size() != pitches.size() || frames.size() != pitches.size())
+        return kFunctionInvalidArgsError;
+    // the frames and PVT points already carry the transposition they were compiled with
+    if (trajectory.transpose != transpose)
+        return kFunctionInvalidArgsError;
+    if (!(hopSize >= MIN_HOP_SIZE && hopSize <= MAX_HOP_SIZE))
+        return kFunctionInvalidArgsError;
+
+    bool bUseIpm = (m_operationMode == EposController::InterpolatedPosition);
+    if (bUseIpm && trajectory.pvtPoints.empty())
+        return kFunctionInvalidArgsError;
+
 //    auto err = m_pFingerController->SetPositionProfile(4000, 20000);
-    auto err = m_pFingerController->SetPositionProfile(4000, 30000);
+    auto err = m_pFingerController->SetPositionProfile(SLIDE_PROFILE_VELOCITY, SLIDE_PROFILE_ACCELERATION);
 //    auto err = m_pFingerController->SetPositionProfile(5000, 45000);
 //    auto err = m_pFingerController->ActivatePositionMode();
     if (err != kNoError)
@@ -173,7 +289,7 @@ Error_t Hathaani::Perform(const vector<float> &pitches, const vector<size_t> &bo
         }
 
     }
-    m_fFretPosition = firstPitch + transpose;
+    SetFretPosition(firstPitch + transpose);
     err = m_pBowController->setString(BowController::String::D);
     if (err != kNoError)
         return err;
@@ -184,29 +300,75 @@ Error_t Hathaani::Perform(const vector<float> &pitches, const vector<size_t> &bo
     err = m_pBowController->StartBowing(maxAmplitude, Bow::Down, err);
     if (err != kNoError)
         return err;
-    size_t bowIdx = 0;
-    for (size_t i=0; i < pitches.size(); i++) {
-//        auto now = std::chrono::steady_clock::now();
-        if (bowIdx < bowChange.size())
-            if (bowChange[bowIdx] == i) {
-                m_pBowController->changeDirection();
-                bowIdx++;
-            }
+    size_t iNextBowFrame = 0;
+    size_t iNextAmplitudeFrame = 0;
+    FrameScheduler scheduler(std::chrono::microseconds((long)(hopSize * 1e6f)));
+    if (!timeStamps.empty())
+        scheduler.setTimeStamps(timeStamps);
+
+    if (bUseIpm) {
+        LOG_INFO("Streaming {} PVT points for {} frames", trajectory.pvtPoints.size(), pitches.size());
+        err = m_ipmTrajectory.Init(m_pFingerController, trajectory.pvtPoints);
+    }
+
+    scheduler.start();
+    if (bUseIpm && err == kNoError)
+        err = m_ipmTrajectory.Start();
+
+    if (err != kNoError) {
+        // The bow is already on the string and the drive may be in interpolated position mode
+        LOG_ERROR("Could not start the IPM trajectory");
+        m_ipmTrajectory.Reset();
+        m_pBowController->stopBowing(kNoError);
+        m_pFingerController->Rest();
+        return err;
+    }
+
+    for (size_t i=0; i < pitches.size(); i = scheduler.next(i)) {
+        // Frames may have been dropped, so apply every bow change that is due by now
+        for (; iNextBowFrame <= i; ++iNextBowFrame) {
+            if (score.bowChange[iNextBowFrame])
+                m_setpoint.bowDirection = m_pBowController->changeDirection();
+        }
 
-        if (i%50 == 0)
-            m_pBowController->setAmplitude(amplitude[i] * maxAmplitude);
-        float p = pitches[i] + transpose;
+        bool bUpdateAmplitude = (i >= iNextAmplitudeFrame);
+        if (bUpdateAmplitude) {
+            m_setpoint.fBowAmplitude = amplitude[i] * maxAmplitude;
+            iNextAmplitudeFrame = (i / 50 + 1) * 50;
+        }
+
+        // The slide target only changes at segment boundaries (and turning points of an oscillation),
+        // so the tracking thread sends one move per segment instead of one per frame
+        m_setpoint.bFingerOn = (pitches[i] >= 0.0);
+        if (m_setpoint.bFingerOn) {
+            const auto& frame = frames[i];
+            m_setpoint.fFretPosition = frame.fFretPosition;
+            m_setpoint.fSlideTarget = frame.fSlideTarget;
+            m_setpoint.fSlideSpeed = frame.fSlideSpeed;
+            m_setpoint.lSlideTarget = frame.lSlideTarget;
+            m_setpoint.ulSlideVelocity = frame.ulSlideVelocity;
+        }
+
+        // Publish the whole frame before the slow bus writes so the tracking thread sees it right away
+        PublishSetpoint();
 
-        if (pitches[i] >= 0.0) {
-            m_fFretPosition = p;
+        if (bUpdateAmplitude)
+            m_pBowController->setAmplitude(m_setpoint.fBowAmplitude);
+
+        if (m_setpoint.bFingerOn) {
             m_pFingerController->On();
         } else {
 //            std::cout << pitches[i] << std::endl;
             m_pFingerController->Off();
         }
-//        std::this_thread::sleep_until(now + std::chrono::microseconds(5500));
-        std::this_thread::sleep_for(std::chrono::microseconds(5500)); // number depends on hopsize of pitch track
     }
+    scheduler.waitUntil(scheduler.getDeadline(pitches.size()));
+
+    if (bUseIpm)
+        m_ipmTrajectory.Reset();
+
+    if (scheduler.getNumDroppedFrames() > 0)
+        LOG_WARN("Dropped {} of {} frames", scheduler.getNumDroppedFrames(), pitches.size());
 
 //    std::this_thread::sleep_for(std::chrono::milliseconds(100));
     m_pBowController->stopBowing(kNoError);
@@ -215,14 +377,37 @@ Error_t Hathaani::Perform(const vector<float> &pitches, const vector<size_t> &bo
 }
 
 void Hathaani::PitchCorrect() {
+    uint32_t uiSequence = 0;
+    float fCorrection = 0;
     while (!m_bInterruptPitchCorrection) {
+        // A correction only applies to the setpoint it was measured against
+        auto setpoint = m_setpointChannel.read();
+        if (setpoint.uiSequence != uiSequence) {
+            uiSequence = setpoint.uiSequence;
+            fCorrection = 0;
+        }
+
         auto correction = m_pCTuner->GetNoteCorrection();
-        m_fFretPosition += (PITCH_CORRECTION_FACTOR * correction);
+        fCorrection += (PITCH_CORRECTION_FACTOR * correction);
+        m_fPitchCorrection = fCorrection;
 //        std::cout << m_pfFretPosition << std::endl;
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 }
 
+void Hathaani::SetFretPosition(float fFretPosition) {
+    m_setpoint.fFretPosition = fFretPosition;
+    m_setpoint.fSlideTarget = fFretPosition;
+    m_setpoint.fSlideSpeed = 0;
+    m_setpoint.lSlideTarget = Util::fret2Position(fFretPosition);
+    m_setpoint.ulSlideVelocity = SLIDE_PROFILE_VELOCITY;
+    PublishSetpoint();
+}
+
+void Hathaani::PublishSetpoint() {
+    m_setpointChannel.publish(m_setpoint);
+}
+
 Error_t Hathaani::Perform(Hathaani::Key key, Hathaani::Mode mode, int interval_ms, float amplitude, short transpose) {
     auto err = m_pFingerController->ActivatePositionMode();
     if (err != kNoError)
@@ -238,7 +423,7 @@ Error_t Hathaani::Perform(Hathaani::Key key, Hathaani::Mode mode, int interval_m
         return err;
     }
 
-    m_fFretPosition = 0;
+    SetFretPosition(0);
     std::this_thread::sleep_for(std::chrono::seconds(5));
 //    int n = (int) positions.size();
 //    err = m_pFingerController->Rest();
@@ -285,6 +470,10 @@ Error_t Hathaani::Perform(Hathaani::Key key, Hathaani::Mode mode, int interval_m
     return m_pFingerController->Rest();
 }
 
+void Hathaani::setOperationMode(EposController::OperationMode mode) {
+    m_operationMode = mode;
+}
+
 Error_t Hathaani::GetPositionsForScale(std::vector<float>& positions, Hathaani::Key key, Hathaani::Mode mode, short transpose) {
     switch (mode) {
         case Major:
@@ -343,13 +532,13 @@ Error_t Hathaani::Play(float amplitude) {
     if (err != kNoError)
         return err;
     for (int i = 0; i < (int)positionArohanam.size(); i++) {
-        m_fFretPosition = positionArohanam[i] - 1;
-        if (m_fFretPosition >= 1)
+        SetFretPosition(positionArohanam[i] - 1);
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
         stringstream msg;
-        msg << "move to position = " << m_fFretPosition;
+        msg << "move to position = " << m_setpoint.fFretPosition;
 //        LogInfo(msg.str());
         msg.str(std::string());
 
@@ -364,13 +553,13 @@ Error_t Hathaani::Play(float amplitude) {
     m_pBowController->changeDirection();
     m_pBowController->setAmplitude(amplitude, kNoError);
     for (int i = 0; i < (int)positionAvarohanam.size(); i++) {
-        m_fFretPosition = positionAvarohanam[i] - 1;
-        if (m_fFretPosition >= 1)
+        SetFretPosition(positionAvarohanam[i] - 1);
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
         stringstream msg;
-        msg << "move to position = " << m_fFretPosition;
+        msg << "move to position = " << m_setpoint.fFretPosition;
 //        LogInfo(msg.str());
         msg.str(std::string());
 
@@ -488,7 +677,7 @@ Error_t Hathaani::Play(float amplitude) {
 void Hathaani::SetupTuner() {
     CTuner::Create(m_pCTuner);
 
-    if (m_pCTuner->Init(&m_fFretPosition) != kNoError) {
+    if (m_pCTuner->Init(&m_setpointChannel) != kNoError) {
         LogInfo("Tuner init failed. Tuner will be switched off...");
         m_bTunerOn = false;
         CTuner::Destroy(m_pCTuner);
@@ -573,13 +762,13 @@ Error_t Hathaani::PerformSpurita(int exampleNumber, int interval_ms, float ampli
             m_pBowController->changeDirection();
             m_pBowController->setAmplitude(amplitude, kNoError);
         }
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
         if (err != kNoError) {
             return m_pFingerController->Rest();;
         }
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -653,13 +842,13 @@ Error_t Hathaani::PerformJaaru(int exampleNumber, int interval_ms, float amplitu
             }
         }
 
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
         if (err != kNoError) {
             return m_pFingerController->Rest();;
         }
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -721,13 +910,13 @@ Error_t Hathaani::PerformNokku(int exampleNumber, int interval_ms, float amplitu
             m_pBowController->setAmplitude(amplitude, kNoError);
         }
 
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
 
         if (err != kNoError)
             return m_pFingerController->Rest();
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -769,12 +958,12 @@ Error_t Hathaani::PerformOdukkal(int interval_ms, float amplitude)
             m_pBowController->setAmplitude(amplitude, kNoError);
         }
 
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
         if (err != kNoError)
             return m_pFingerController->Rest();
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -817,12 +1006,12 @@ Error_t Hathaani::PerformOrikkai(int interval_ms, float amplitude)
             m_pBowController->setAmplitude(amplitude, kNoError);
         }
 
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
         if (err != kNoError)
             return m_pFingerController->Rest();
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -865,12 +1054,12 @@ Error_t Hathaani::PerformKhandippu(int interval_ms, float amplitude)
 //            m_pBowController->setAmplitude(amplitude, kNoError);
 //        }
 
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
         if (err != kNoError)
             return m_pFingerController->Rest();
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -948,12 +1137,12 @@ Error_t Hathaani::PerformKampita(int exampleNumber, int interval_ms, float ampli
             m_pBowController->setAmplitude(amplitude, kNoError);
         }
 
-        m_fFretPosition = position[i] - 1;
-        err = m_pFingerController->moveToPosition(m_fFretPosition);
+        SetFretPosition(position[i] - 1);
+        err = m_pFingerController->moveToPosition(m_setpoint.fFretPosition);
         if (err != kNoError)
             return m_pFingerController->Rest();
 
-        if (m_fFretPosition >= 1)
+        if (m_setpoint.fFretPosition >= 1)
             err = m_pFingerController->On();
         else
             err = m_pFingerController->Off();
@@ -0,0 +1,194 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include "IpmTrajectory.h"
+
+#include <algorithm>
+#include <utility>
+
+Error_t IpmTrajectory::Compute(std::vector<PvtPoint>& points, const std::vector<MotionSegment>& segments, int8_t transpose,
+                               float hopSize, Span<float> timeStamps)
+{
+    if (segments.empty() || hopSize <= 0)
+        return kFunctionInvalidArgsError;
+
+    size_t iNumFrames = segments.back().iEndFrame;
+    if (!timeStamps.empty() && timeStamps.size() != iNumFrames)
+        return kFunctionInvalidArgsError;
+
+    // Time (seconds) of a fractional frame and its length, interpolated between the timestamps
+    auto getFrameDuration = [&](double fFrame) -> double {
+        if (timeStamps.empty() || iNumFrames < 2)
+            return hopSize;
+        auto i = std::min((size_t)fFrame, iNumFrames - 2);
+        auto fDuration = (double)(timeStamps[i + 1] - timeStamps[i]);
+        return (fDuration > 0) ? fDuration : hopSize;
+    };
+    auto getFrameTime = [&](double fFrame) -> double {
+        if (timeStamps.empty())
+            return fFrame * hopSize;
+        auto i = std::min((size_t)fFrame, iNumFrames - 1);
+        return timeStamps[i] + (fFrame - (double)i) * getFrameDuration(fFrame);
+    };
+
+    // Key frames of each segment, with extra ones in between where a segment is too long for the drive
+    std::vector<double> keyFrames;
+    for (const auto& segment : segments) {
+        std::vector<double> segmentFrames;
+        segmentFrames.push_back((double)segment.iStartFrame);
+        if (segment.type == MotionSegment::Oscillation) {
+            auto fLast = (double)(segment.iEndFrame - 1);
+            for (double f = segment.iStartFrame + segment.fHalfPeriod / 2; f < fLast; f += segment.fHalfPeriod / 2)
+                segmentFrames.push_back(f);
+        }
+        if (segment.iEndFrame - 1 > segment.iStartFrame)
+            segmentFrames.push_back((double)(segment.iEndFrame - 1));
+
+        for (size_t k = 0; k < segmentFrames.size(); ++k) {
+            if (k > 0) {
+                auto fGapMs = 1000 * (getFrameTime(segmentFrames[k]) - getFrameTime(segmentFrames[k - 1]));
+                // one ms of margin for rounding
+                auto iNumSplits = (int)std::ceil(fGapMs / (IPM_MAX_SEGMENT_MS - 1));
+                for (int j = 1; j < iNumSplits; ++j)
+                    keyFrames.push_back(segmentFrames[k - 1] + (segmentFrames[k] - segmentFrames[k - 1]) * j / iNumSplits);
+            }
+            keyFrames.push_back(segmentFrames[k]);
+        }
+    }
+
+    // The drive only takes whole milliseconds, so key frames are placed at their rounded absolute time
+    // to keep the total duration exact. Key frames that round to the same time keep the latest one.
+    std::vector<long> times;
+    points.clear();
+    points.reserve(keyFrames.size());
+    size_t iSegment = 0;
+    for (double fFrame : keyFrames) {
+        while (iSegment < segments.size() - 1 && (double)segments[iSegment].iEndFrame <= fFrame)
+            ++iSegment;
+        const auto& segment = segments[iSegment];
+
+        auto fFret = TrajectoryCompiler::Evaluate(segment, fFrame) + transpose;
+        auto fFretsPerSecond = TrajectoryCompiler::GetSlope(segment, fFrame) / getFrameDuration(fFrame);
+
+        PvtPoint point {};
+        point.lPosition = std::clamp(Util::fret2Position(fFret), (long)NUT_POSITION, (long)MAX_ENCODER_INC - 1);
+        point.lVelocity = std::lround(Util::FretSpeedToRpm(fFret, fFretsPerSecond));
+
+        long lTime = std::lround(1000 * getFrameTime(fFrame));
+        if (!times.empty() && lTime <= times.back()) {
+            points.back() = point;
+            continue;
+        }
+        times.push_back(lTime);
+        points.push_back(point);
+    }
+
+    for (size_t k = 0; k < points.size(); ++k)
+        points[k].uiTimeMs = (k < points.size() - 1) ? (uint8_t)std::min(times[k + 1] - times[k], (long)IPM_MAX_SEGMENT_MS) : 0;
+
+    // Start and end at rest
+    points.front().lVelocity = 0;
+    points.back().lVelocity = 0;
+
+    return kNoError;
+}
+
+Error_t IpmTrajectory::Init(EposController* pController, std::vector<PvtPoint> points)
+{
+    if (!pController || points.empty())
+        return kFunctionInvalidArgsError;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_points = std::move(points);
+    m_iNextPoint = 0;
+
+    // moveToPositionl does not work in interpolated position mode, so never restore that one
+    m_previousMode = pController->getOperationMode();
+    if (m_previousMode == EposController::InterpolatedPosition)
+        m_previousMode = EposController::ProfilePosition;
+
+    auto err = pController->ActivateInterpolatedPositionMode();
+    if (err != kNoError) {
+        pController->ActivateOperationMode(m_previousMode);
+        return err;
+    }
+
+    m_pController = pController;
+    return FillBuffer();
+}
+
+Error_t IpmTrajectory::Reset()
+{
+    auto err = Stop();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_points.clear();
+    m_iNextPoint = 0;
+    return err;
+}
+
+Error_t IpmTrajectory::Track(const std::function<Error_t()>& updateTarget, bool& bLoaded)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bLoaded = (m_pController != nullptr);
+    return bLoaded ? FillBuffer() : updateTarget();
+}
+
+Error_t IpmTrajectory::FillBuffer()
+{
+    if (!m_pController || m_iNextPoint >= m_points.size())
+        return kNoError;
+
+    unsigned int uiFree = 0;
+    auto err = m_pController->GetFreeIpmBufferSize(uiFree);
+    if (err != kNoError)
+        return err;
+
+    for (; uiFree > 0 && m_iNextPoint < m_points.size(); --uiFree, ++m_iNextPoint) {
+        const auto& point = m_points[m_iNextPoint];
+        err = m_pController->AddPvtPoint(point.lPosition, point.lVelocity, point.uiTimeMs);
+        if (err != kNoError)
+            return err;
+    }
+
+    return kNoError;
+}
+
+Error_t IpmTrajectory::Start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pController)
+        return kNotInitializedError;
+
+    auto err = m_pController->StartIpmTrajectory();
+    if (err != kNoError)
+        return err;
+
+    m_bStreaming = true;
+    return kNoError;
+}
+
+Error_t IpmTrajectory::Stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pController) {
+        m_bStreaming = false;
+        return kNoError;
+    }
+
+    EposController::IpmStatus status;
+    if (m_pController->GetIpmStatus(status) == kNoError && status.bError)
+        LOG_ERROR("IPM trajectory error after {} of {} points", m_iNextPoint, m_points.size());
+
+    auto err = m_pController->StopIpmTrajectory();
+    auto modeErr = m_pController->ActivateOperationMode(m_previousMode);
+    if (err == kNoError)
+        err = modeErr;
+    if (modeErr != kNoError)
+        LOG_ERROR("Could not restore the operation mode after the IPM trajectory");
+
+    // only now that the drive is back in its previous mode may the tracking thread send targets again
+    m_bStreaming = false;
+    m_pController = nullptr;
+    return err;
+}
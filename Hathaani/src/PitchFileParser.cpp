@@ -4,8 +4,176 @@
 
 #include "PitchFileParser.h"
 
+#include <cstdio>
+#include <cstring>
 #include <utility>
 
+#include "rapidjson/filereadstream.h"
+#include "rapidjson/reader.h"
+
+namespace {
+    /* SAX handler for the score: numbers in the known top level arrays go straight into the output
+     * vectors, everything else is skipped. Returning false stops the reader with a parse error. */
+    class ScoreHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ScoreHandler> {
+    public:
+        enum Member {
+            kUnknown,
+            kPitch,
+            kBow,
+            kAmplitude,
+            kHop,
+            kTime,
+
+            kNumMembers
+        };
+
+        ScoreHandler(std::vector<float>& pitches, std::vector<size_t>& bowChanges, std::vector<float>& amplitude,
+                     float& hopSize, std::vector<float>& timeStamps, size_t iFrameHint) :
+                m_pitches(pitches), m_bowChanges(bowChanges), m_amplitude(amplitude),
+                m_fHopSize(hopSize), m_timeStamps(timeStamps), m_iFrameHint(iFrameHint) {}
+
+        bool StartObject() {
+            // the root is the only object the score defines
+            return ++m_iDepth == 1 || isSkipping();
+        }
+
+        bool EndObject(rapidjson::SizeType) {
+            --m_iDepth;
+            return true;
+        }
+
+        bool Key(const char* str, rapidjson::SizeType len, bool) {
+            if (m_iDepth != 1)
+                return true;
+
+            m_eMember = kUnknown;
+            static const char* const kMembers[kNumMembers] = {"", "pitch", "bow", "amplitude", "hop", "time"};
+            for (int i = kPitch; i < kNumMembers; ++i) {
+                if (len == std::strlen(kMembers[i]) && std::strncmp(str, kMembers[i], len) == 0)
+                    m_eMember = static_cast<Member>(i);
+            }
+
+            // first occurrence wins, like Document::operator[]
+            if (m_eMember != kUnknown && m_abSeen[m_eMember])
+                m_eMember = kUnknown;
+            m_abSeen[m_eMember] = true;
+            return true;
+        }
+
+        bool StartArray() {
+            ++m_iDepth;
+            if (m_iDepth == 1)
+                return false;
+            if (m_iDepth > 2)
+                return isSkipping();
+
+            // every frame has one value in pitch, amplitude and time: the first of them to arrive
+            // is reserved from the file size, the others from its length
+            switch (m_eMember) {
+                case kPitch:
+                    m_pitches.clear();
+                    m_pitches.reserve(m_iFrameHint);
+                    break;
+                case kAmplitude:
+                    m_amplitude.clear();
+                    m_amplitude.reserve(m_iFrameHint);
+                    break;
+                case kTime:
+                    m_timeStamps.clear();
+                    m_timeStamps.reserve(m_iFrameHint);
+                    break;
+                case kBow:
+                    m_bowChanges.clear();
+                    break;
+                case kHop:
+                    return false;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType iLength) {
+            if (--m_iDepth == 1 && m_eMember != kUnknown && m_eMember != kBow)
+                m_iFrameHint = iLength;
+            return true;
+        }
+
+        bool Int(int i) { return integer(i); }
+        bool Uint(unsigned u) { return integer(u); }
+        bool Int64(int64_t i) { return integer(i); }
+        bool Uint64(uint64_t u) { return integer(u); }
+        bool Double(double d) { return number(d, false); }
+
+        /* strings, bools and null are only fine where nothing is read */
+        bool Default() { return isSkipping(); }
+
+        /* the required arrays were all there */
+        [[nodiscard]] bool isComplete() const {
+            return m_abSeen[kPitch] && m_abSeen[kBow] && m_abSeen[kAmplitude];
+        }
+
+        [[nodiscard]] bool hasTime() const {
+            return m_abSeen[kTime];
+        }
+
+    private:
+        template <typename T>
+        bool integer(T value) {
+            return number(static_cast<double>(value), value >= 0);
+        }
+
+        bool number(double value, bool bIsIndex) {
+            if (isSkipping())
+                return true;
+            if (m_iDepth == 1) {
+                auto fHopSize = static_cast<float>(value);
+                if (m_eMember != kHop || !(fHopSize >= MIN_HOP_SIZE && fHopSize <= MAX_HOP_SIZE))
+                    return false;
+                m_fHopSize = fHopSize;
+                return true;
+            }
+
+            switch (m_eMember) {
+                case kPitch:
+                    m_pitches.push_back(static_cast<float>(value));
+                    return true;
+                case kAmplitude:
+                    m_amplitude.push_back(static_cast<float>(value));
+                    return true;
+                case kBow:
+                    if (!bIsIndex)
+                        return false;
+                    m_bowChanges.push_back(static_cast<size_t>(value));
+                    return true;
+                case kTime:
+                    if (!m_timeStamps.empty() && static_cast<float>(value) < m_timeStamps.back())
+                        return false;
+                    m_timeStamps.push_back(static_cast<float>(value));
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /* anywhere inside the value of a member that is not read */
+        [[nodiscard]] bool isSkipping() const {
+            return m_iDepth >= 1 && m_eMember == kUnknown;
+        }
+
+        std::vector<float>& m_pitches;
+        std::vector<size_t>& m_bowChanges;
+        std::vector<float>& m_amplitude;
+        float& m_fHopSize;
+        std::vector<float>& m_timeStamps;
+
+        size_t m_iFrameHint;
+        int m_iDepth = 0;
+        Member m_eMember = kUnknown;
+        bool m_abSeen[kNumMembers] = {};
+    };
+}
+
 PitchFileParser::PitchFileParser(string filePath) : m_sFilePath(std::move(filePath)), m_bSetPath(false), m_fPitches(nullptr) {
     m_file.open(m_sFilePath);
     if (!m_file.is_open()) {
@@ -109,42 +277,43 @@ Error_t PitchFileParser::GetLength(size_t& length, const Error_t& error) {
 }
 
 Error_t PitchFileParser::parseJson(std::vector<float>& pitches, std::vector<size_t>& bowChanges, std::vector<float>& amplitude)
+{
+    float hopSize;
+    std::vector<float> timeStamps;
+    return parseJson(pitches, bowChanges, amplitude, hopSize, timeStamps);
+}
+
+Error_t PitchFileParser::parseJson(std::vector<float>& pitches, std::vector<size_t>& bowChanges, std::vector<float>& amplitude,
+                                   float& hopSize, std::vector<float>& timeStamps)
 {
     if (!m_file.is_open())
         return kFileOpenError;
 
-    using namespace rapidjson;
-    Document map;
-    string strObj;
-    std::getline(m_file, strObj, '\0');
+    std::FILE* pFile = std::fopen(m_sFilePath.c_str(), "rb");
+    if (!pFile)
+        return kFileOpenError;
 
-    if (map.Parse(strObj.c_str()).HasParseError())
-        return kFileParseError;
+    // a pretty printed frame takes ~19 bytes of the file (pitch and amplitude), so this reserves
+    // a little more than the bundled scores need and is one regrow away for compact ones
+    std::fseek(pFile, 0, SEEK_END);
+    auto iFileSize = std::ftell(pFile);
+    std::rewind(pFile);
+    size_t iFrameHint = iFileSize > 0 ? static_cast<size_t>(iFileSize) / kBytesPerFrameEstimate : 0;
 
-    assert(map.HasMember("pitch"));
-    assert(map["pitch"].IsArray());
-    const Value& pitch = map["pitch"];
-    pitches.resize(pitch.Size());
-    for (SizeType i = 0; i < pitch.Size(); ++i) {
-        pitches[i] = pitch[i].GetFloat();
-    }
+    hopSize = PITCH_HOP_SIZE_US * 1e-6f;
+    ScoreHandler handler(pitches, bowChanges, amplitude, hopSize, timeStamps, iFrameHint);
+    timeStamps.clear();
 
-    assert(map.HasMember("bow"));
-    assert(map["bow"].IsArray());
-    const Value& bow = map["bow"];
-    bowChanges.resize(bow.Size());
-    for (SizeType i = 0; i < bow.Size(); ++i) {
-        bowChanges[i] = bow[i].GetInt();
-    }
+    std::vector<char> readBuffer(kReadBufferSize);
+    rapidjson::FileReadStream stream(pFile, readBuffer.data(), readBuffer.size());
+    rapidjson::Reader reader;
+    bool bParsed = !reader.Parse(stream, handler).IsError();
+    std::fclose(pFile);
 
-    assert(map.HasMember("amplitude"));
-    assert(map["amplitude"].IsArray());
-    const Value& amp = map["amplitude"];
-    amplitude.resize(amp.Size());
-    for (SizeType i = 0; i < amp.Size(); ++i) {
-        amplitude[i] = amp[i].GetFloat();
-    }
+    if (!bParsed || !handler.isComplete())
+        return kFileParseError;
+    if (handler.hasTime() && timeStamps.size() != pitches.size())
+        return kFileParseError;
 
     return kNoError;
 }
-
@@ -0,0 +1,174 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include "Score.h"
+
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kMagic[4] = {'H', 'S', 'C', 'R'};
+
+    struct Header {
+        char acMagic[4];
+        uint32_t uiVersion;
+        uint32_t uiFlags;
+        float fHopSize;
+        uint64_t uiNumFrames;
+        uint8_t auiReserved[40];
+    };
+    static_assert(sizeof(Header) == BinaryScore::kAlignment, "the columns start right after the header");
+    // the columns are handed out in place, so the file's byte order has to be the host's
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "BinaryScore files are little endian");
+
+    size_t align(size_t iOffset) {
+        return (iOffset + BinaryScore::kAlignment - 1) & ~(BinaryScore::kAlignment - 1);
+    }
+
+    /* Offsets of the columns and the end of the file for a header */
+    struct Layout {
+        size_t iPitches, iAmplitude, iTimeStamps, iBowChange, iEnd;
+
+        explicit Layout(const Header& header) {
+            auto iNumFrames = static_cast<size_t>(header.uiNumFrames);
+            iPitches = sizeof(Header);
+            iAmplitude = align(iPitches + iNumFrames * sizeof(float));
+            iTimeStamps = align(iAmplitude + iNumFrames * sizeof(float));
+            iBowChange = (header.uiFlags & BinaryScore::kHasTimeStamps) ? align(iTimeStamps + iNumFrames * sizeof(float)) : iTimeStamps;
+            iEnd = iBowChange + iNumFrames;
+        }
+    };
+}
+
+void Score::FlagBowChanges(std::vector<uint8_t>& flags, const std::vector<size_t>& bowChanges, size_t iNumFrames) {
+    flags.assign(iNumFrames, 0);
+    for (auto iFrame : bowChanges) {
+        if (iFrame < iNumFrames)
+            flags[iFrame] = 1;
+    }
+}
+
+BinaryScore::~BinaryScore() {
+    Close();
+}
+
+Error_t BinaryScore::Open(const std::string& filePath) {
+    Close();
+
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return kFileOpenError;
+
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return kFileAccessError;
+    }
+    auto iFileSize = static_cast<size_t>(fileStat.st_size);
+    if (iFileSize < sizeof(Header)) {
+        close(fd);
+        return kFileParseError;
+    }
+
+    int iFlags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    iFlags |= MAP_POPULATE;
+#endif
+    void* pMapping = mmap(nullptr, iFileSize, PROT_READ, iFlags, fd, 0);
+    close(fd);
+    if (pMapping == MAP_FAILED)
+        return kFileAccessError;
+
+    m_pMapping = pMapping;
+    m_iMappingSize = iFileSize;
+
+    Header header {};
+    std::memcpy(&header, m_pMapping, sizeof(header));
+    if (std::memcmp(header.acMagic, kMagic, sizeof(kMagic)) != 0 || header.uiVersion != kVersion ||
+        header.uiNumFrames == 0 || header.uiNumFrames > iFileSize ||
+        !(header.fHopSize >= MIN_HOP_SIZE && header.fHopSize <= MAX_HOP_SIZE)) {
+        Close();
+        return kFileParseError;
+    }
+
+    Layout layout(header);
+    if (layout.iEnd > iFileSize) {
+        Close();
+        return kFileParseError;
+    }
+
+    auto iNumFrames = static_cast<size_t>(header.uiNumFrames);
+    const auto* pBase = static_cast<const uint8_t*>(m_pMapping);
+    m_score.pitches = Span<float>(reinterpret_cast<const float*>(pBase + layout.iPitches), iNumFrames);
+    m_score.amplitude = Span<float>(reinterpret_cast<const float*>(pBase + layout.iAmplitude), iNumFrames);
+    m_score.bowChange = Span<uint8_t>(pBase + layout.iBowChange, iNumFrames);
+    if (header.uiFlags & kHasTimeStamps)
+        m_score.timeStamps = Span<float>(reinterpret_cast<const float*>(pBase + layout.iTimeStamps), iNumFrames);
+    m_score.hopSize = header.fHopSize;
+
+    return kNoError;
+}
+
+void BinaryScore::Close() {
+    if (m_pMapping)
+        munmap(m_pMapping, m_iMappingSize);
+
+    m_pMapping = nullptr;
+    m_iMappingSize = 0;
+    m_score = Score();
+}
+
+Error_t BinaryScore::Write(const std::string& filePath, const Score& score) {
+    size_t iNumFrames = score.pitches.size();
+    if (iNumFrames == 0 || score.amplitude.size() != iNumFrames || score.bowChange.size() != iNumFrames ||
+        !(score.hopSize >= MIN_HOP_SIZE && score.hopSize <= MAX_HOP_SIZE))
+        return kFunctionInvalidArgsError;
+    if (!score.timeStamps.empty()) {
+        if (score.timeStamps.size() != iNumFrames)
+            return kFunctionInvalidArgsError;
+        for (size_t i = 1; i < iNumFrames; ++i) {
+            if (score.timeStamps[i] < score.timeStamps[i - 1])
+                return kFunctionInvalidArgsError;
+        }
+    }
+
+    Header header {};
+    std::memcpy(header.acMagic, kMagic, sizeof(kMagic));
+    header.uiVersion = kVersion;
+    header.uiFlags = score.timeStamps.empty() ? 0 : kHasTimeStamps;
+    header.fHopSize = score.hopSize;
+    header.uiNumFrames = iNumFrames;
+    Layout layout(header);
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return kFileOpenError;
+
+    auto writeColumn = [&](size_t iOffset, const void* pData, size_t iSize) {
+        static const char acPadding[kAlignment] = {};
+        file.write(acPadding, static_cast<std::streamsize>(iOffset - static_cast<size_t>(file.tellp())));
+        file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(iSize));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeColumn(layout.iPitches, score.pitches.data(), iNumFrames * sizeof(float));
+    writeColumn(layout.iAmplitude, score.amplitude.data(), iNumFrames * sizeof(float));
+    if (header.uiFlags & kHasTimeStamps)
+        writeColumn(layout.iTimeStamps, score.timeStamps.data(), iNumFrames * sizeof(float));
+    writeColumn(layout.iBowChange, score.bowChange.data(), iNumFrames);
+
+    file.close();
+    return file.fail() ? kFileWriteError : kNoError;
+}
+
+bool BinaryScore::IsBinaryScore(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    char acMagic[sizeof(kMagic)] = {};
+    return file.read(acMagic, sizeof(acMagic)) && std::memcmp(acMagic, kMagic, sizeof(kMagic)) == 0;
+}
@@ -0,0 +1,282 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include "ScoreCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PitchFileParser.h"
+
+namespace {
+    const size_t kHashBlockSize = 1 << 16;
+    const char kTrajectoryMagic[4] = {'H', 'T', 'R', 'J'};
+
+    struct TrajectoryHeader {
+        char acMagic[4];
+        uint32_t uiSegmentSize;     // sizeof(MotionSegment), the arrays are stored as they are in memory
+        uint32_t uiPointSize;       // sizeof(PvtPoint)
+        uint32_t uiFrameSize;       // sizeof(FrameTarget)
+        uint64_t uiNumSegments;
+        uint64_t uiNumPoints;
+        uint64_t uiNumFrames;
+    };
+
+    // the arrays are written and read as raw bytes, in host byte order
+    static_assert(std::is_trivially_copyable_v<MotionSegment>, "MotionSegment is stored as it is in memory");
+    static_assert(std::is_trivially_copyable_v<PvtPoint>, "PvtPoint is stored as it is in memory");
+    static_assert(std::is_trivially_copyable_v<FrameTarget>, "FrameTarget is stored as it is in memory");
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "trajectory files are little endian");
+
+    template <class T>
+    uint64_t getDataSize(const std::vector<T>& items) {
+        return items.size() * sizeof(T);
+    }
+
+    inline uint64_t rotl(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    /* Hashes 8 bytes per step. A trailing partial word is zero padded, so only the last
+     * update() of a stream may have a length that is not a multiple of 8. */
+    class Hasher {
+    public:
+        explicit Hasher(uint64_t uiSeed) : m_uiHash(uiSeed) {}
+
+        void update(const uint8_t* pData, size_t iSize) {
+            for (size_t i = 0; i < iSize; i += sizeof(uint64_t)) {
+                uint64_t uiWord = 0;
+                std::memcpy(&uiWord, pData + i, std::min(sizeof(uint64_t), iSize - i));
+
+                uiWord *= 0x87c37b91114253d5ULL;
+                uiWord = rotl(uiWord, 31);
+                uiWord *= 0x4cf5ad432745937fULL;
+                m_uiHash ^= uiWord;
+                m_uiHash = rotl(m_uiHash, 27) * 5 + 0x52dce729;
+            }
+            m_uiLength += iSize;
+        }
+
+        uint64_t finish() const {
+            uint64_t h = m_uiHash ^ m_uiLength;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+    private:
+        uint64_t m_uiHash;
+        uint64_t m_uiLength = 0;
+    };
+
+    std::string toHex(uint64_t uiValue) {
+        char acHex[17];
+        std::snprintf(acHex, sizeof(acHex), "%016llx", static_cast<unsigned long long>(uiValue));
+        return acHex;
+    }
+
+    Error_t makeDirectory(const std::string& directory) {
+        if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+            return kFileWriteError;
+        return kNoError;
+    }
+
+    /* Moves a finished temporary file over the entry, readers never see a partial one */
+    Error_t commit(const std::string& tempPath, const std::string& filePath) {
+        if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return kFileWriteError;
+        }
+        return kNoError;
+    }
+}
+
+ScoreCache::ScoreCache(std::string directory) : m_directory(std::move(directory)) {}
+
+Error_t ScoreCache::Load(const std::string& scorePath, BinaryScore& binaryScore) {
+    m_key.clear();
+    m_bHit = false;
+
+    uint64_t uiHash;
+    auto err = HashFile(uiHash, scorePath);
+    if (err != kNoError)
+        return err;
+    m_key = toHex(uiHash);
+
+    // already preprocessed, only its trajectory is cached
+    if (BinaryScore::IsBinaryScore(scorePath)) {
+        m_bHit = true;
+        return binaryScore.Open(scorePath);
+    }
+
+    // a file from an older BinaryScore version fails to open and is rebuilt like a missing one
+    std::string filePath = m_directory + "/" + m_key + ".hsc";
+    if (binaryScore.Open(filePath) == kNoError) {
+        m_bHit = true;
+        return kNoError;
+    }
+
+    std::vector<float> pitches, amplitude, timeStamps;
+    std::vector<size_t> bowChangeIdx;
+    float hopSize;
+    PitchFileParser pitchFileParser(scorePath);
+    if ((err = pitchFileParser.parseJson(pitches, bowChangeIdx, amplitude, hopSize, timeStamps)) != kNoError)
+        return err;
+
+    std::vector<uint8_t> bowChangeFlags;
+    Score::FlagBowChanges(bowChangeFlags, bowChangeIdx, pitches.size());
+
+    Score score;
+    score.pitches = pitches;
+    score.amplitude = amplitude;
+    score.bowChange = bowChangeFlags;
+    score.timeStamps = timeStamps;
+    score.hopSize = hopSize;
+
+    if ((err = makeDirectory(m_directory)) != kNoError)
+        return err;
+
+    std::string tempPath = filePath + ".tmp" + std::to_string(getpid());
+    if ((err = BinaryScore::Write(tempPath, score)) != kNoError) {
+        std::remove(tempPath.c_str());
+        return err;
+    }
+    if ((err = commit(tempPath, filePath)) != kNoError)
+        return err;
+
+    return binaryScore.Open(filePath);
+}
+
+Error_t ScoreCache::LoadTrajectory(ScoreTrajectory& trajectory, int8_t transpose) const {
+    if (m_key.empty())
+        return kNotInitializedError;
+
+    std::ifstream file(GetTrajectoryPath(transpose), std::ios::binary);
+    if (!file.is_open())
+        return kFileOpenError;
+
+    TrajectoryHeader header {};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.acMagic, kTrajectoryMagic, sizeof(kTrajectoryMagic)) != 0 ||
+        header.uiSegmentSize != sizeof(MotionSegment) || header.uiPointSize != sizeof(PvtPoint) ||
+        header.uiFrameSize != sizeof(FrameTarget))
+        return kFileParseError;
+
+    // the counts come from the file, check them against its size before allocating
+    file.seekg(0, std::ios::end);
+    auto iDataSize = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+    if (header.uiNumSegments > iDataSize / sizeof(MotionSegment) || header.uiNumPoints > iDataSize / sizeof(PvtPoint) ||
+        header.uiNumFrames > iDataSize / sizeof(FrameTarget) ||
+        header.uiNumSegments * sizeof(MotionSegment) + header.uiNumPoints * sizeof(PvtPoint) +
+        header.uiNumFrames * sizeof(FrameTarget) != iDataSize)
+        return kFileParseError;
+    file.seekg(sizeof(header));
+
+    trajectory.segments.resize(header.uiNumSegments);
+    trajectory.pvtPoints.resize(header.uiNumPoints);
+    trajectory.frames.resize(header.uiNumFrames);
+    file.read(reinterpret_cast<char*>(trajectory.segments.data()), static_cast<std::streamsize>(getDataSize(trajectory.segments)));
+    file.read(reinterpret_cast<char*>(trajectory.pvtPoints.data()), static_cast<std::streamsize>(getDataSize(trajectory.pvtPoints)));
+    file.read(reinterpret_cast<char*>(trajectory.frames.data()), static_cast<std::streamsize>(getDataSize(trajectory.frames)));
+    if (!file) {
+        trajectory.segments.clear();
+        trajectory.pvtPoints.clear();
+        trajectory.frames.clear();
+        return kFileParseError;
+    }
+
+    // the transposition is part of the file name
+    trajectory.transpose = transpose;
+    return kNoError;
+}
+
+Error_t ScoreCache::StoreTrajectory(const ScoreTrajectory& trajectory) const {
+    if (m_key.empty())
+        return kNotInitializedError;
+
+    TrajectoryHeader header {};
+    std::memcpy(header.acMagic, kTrajectoryMagic, sizeof(kTrajectoryMagic));
+    header.uiSegmentSize = sizeof(MotionSegment);
+    header.uiPointSize = sizeof(PvtPoint);
+    header.uiFrameSize = sizeof(FrameTarget);
+    header.uiNumSegments = trajectory.segments.size();
+    header.uiNumPoints = trajectory.pvtPoints.size();
+    header.uiNumFrames = trajectory.frames.size();
+
+    auto err = makeDirectory(m_directory);
+    if (err != kNoError)
+        return err;
+
+    std::string filePath = GetTrajectoryPath(trajectory.transpose);
+    std::string tempPath = filePath + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return kFileOpenError;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(trajectory.segments.data()), static_cast<std::streamsize>(getDataSize(trajectory.segments)));
+    file.write(reinterpret_cast<const char*>(trajectory.pvtPoints.data()), static_cast<std::streamsize>(getDataSize(trajectory.pvtPoints)));
+    file.write(reinterpret_cast<const char*>(trajectory.frames.data()), static_cast<std::streamsize>(getDataSize(trajectory.frames)));
+    file.close();
+    if (file.fail()) {
+        std::remove(tempPath.c_str());
+        return kFileWriteError;
+    }
+
+    return commit(tempPath, filePath);
+}
+
+std::string ScoreCache::GetTrajectoryPath(int8_t transpose) const {
+    // everything besides the score that changes the compiled segments or the pulse targets
+    const float afConfig[] = {
+            (float)kVersion, (float)transpose,
+            TRAJECTORY_TOLERANCE, OSCILLATION_TOLERANCE_FACTOR, OSCILLATION_MIN_DEPTH,
+            OSCILLATION_MIN_RATE, OSCILLATION_MAX_RATE, (float)OSCILLATION_MIN_EXTREMA,
+            SCALE_LENGTH, (float)MAX_ENCODER_INC, (float)NUT_POSITION, P2P_MULTIPLIER,
+            (float)ENCODER_INC_PER_TURN, (float)IPM_MAX_SEGMENT_MS, (float)SLIDE_PROFILE_VELOCITY,
+            (float)Util::kFretTableResolution, (float)Util::kFretTableMaxFret
+    };
+
+    return m_directory + "/" + m_key + "-" + toHex(Hash(afConfig, sizeof(afConfig))) + ".trj";
+}
+
+uint64_t ScoreCache::Hash(const void* pData, size_t iSize, uint64_t uiSeed) {
+    Hasher hasher(uiSeed);
+    hasher.update(static_cast<const uint8_t*>(pData), iSize);
+    return hasher.finish();
+}
+
+Error_t ScoreCache::HashFile(uint64_t& uiHash, const std::string& filePath) {
+    FILE* pFile = std::fopen(filePath.c_str(), "rb");
+    if (!pFile)
+        return kFileOpenError;
+
+    // every block but the last is a whole number of words
+    Hasher hasher(0);
+    std::vector<uint8_t> block(kHashBlockSize);
+    size_t iRead;
+    do {
+        iRead = std::fread(block.data(), 1, block.size(), pFile);
+        hasher.update(block.data(), iRead);
+    } while (iRead == block.size());
+
+    bool bError = std::ferror(pFile) != 0;
+    std::fclose(pFile);
+    if (bError)
+        return kFileAccessError;
+
+    uiHash = hasher.finish();
+    return kNoError;
+}
@@ -0,0 +1,46 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include <iostream>
+
+#include "PitchFileParser.h"
+#include "Score.h"
+#include "Util.h"
+
+/* Converts a JSON score (see PitchFileParser) into a BinaryScore that Hathaani maps at startup */
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <score.json> <score.hsc>\n";
+        return 1;
+    }
+
+    std::vector<float> pitches, amplitude, timeStamps;
+    std::vector<size_t> bowChangeIdx;
+    float hopSize;
+
+    PitchFileParser pitchFileParser(argv[1]);
+    auto err = pitchFileParser.parseJson(pitches, bowChangeIdx, amplitude, hopSize, timeStamps);
+    if (err != kNoError) {
+        CUtil::PrintError(PitchFileParser::kName, err);
+        return 1;
+    }
+
+    std::vector<uint8_t> bowChangeFlags;
+    Score::FlagBowChanges(bowChangeFlags, bowChangeIdx, pitches.size());
+
+    Score score;
+    score.pitches = pitches;
+    score.amplitude = amplitude;
+    score.bowChange = bowChangeFlags;
+    score.timeStamps = timeStamps;
+    score.hopSize = hopSize;
+
+    if ((err = BinaryScore::Write(argv[2], score)) != kNoError) {
+        CUtil::PrintError(BinaryScore::kName, err);
+        return 1;
+    }
+
+    std::cout << "Wrote " << pitches.size() << " frames to " << argv[2] << "\n";
+    return 0;
+}
@@ -0,0 +1,276 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include "TrajectoryCompiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+Error_t TrajectoryCompiler::Compile(std::vector<MotionSegment>& segments, Span<float> pitches,
+                                    float hopSize, float fTolerance)
+{
+    if (pitches.empty() || hopSize <= 0 || fTolerance < 0)
+        return kFunctionInvalidArgsError;
+
+    std::vector<float> track;
+    FillRests(track, pitches);
+
+    std::vector<size_t> extrema;
+    FindExtrema(extrema, track, OSCILLATION_MIN_DEPTH / 2);
+
+    auto fMinHalfPeriod = 0.5f / OSCILLATION_MAX_RATE / hopSize;
+    auto fMaxHalfPeriod = 0.5f / OSCILLATION_MIN_RATE / hopSize;
+
+    segments.clear();
+    size_t iLinearStart = 0;
+    size_t k = 0;
+    while (k + 1 < extrema.size()) {
+        // Longest run of extrema that swing deep enough at a kampita like rate
+        size_t j = k;
+        while (j + 1 < extrema.size()) {
+            auto fSpacing = (float)(extrema[j + 1] - extrema[j]);
+            auto fSwing = std::abs(track[extrema[j + 1]] - track[extrema[j]]);
+            if (fSpacing < fMinHalfPeriod || fSpacing > fMaxHalfPeriod || fSwing < OSCILLATION_MIN_DEPTH)
+                break;
+            ++j;
+        }
+
+        MotionSegment oscillation;
+        bool bFound = false;
+        for (; j + 1 >= k + OSCILLATION_MIN_EXTREMA && !bFound; --j)
+            bFound = FitOscillation(oscillation, track, extrema, k, j, fTolerance * OSCILLATION_TOLERANCE_FACTOR);
+
+        if (!bFound) {
+            ++k;
+            continue;
+        }
+
+        CompileLinear(segments, track, iLinearStart, oscillation.iStartFrame, fTolerance);
+        segments.push_back(oscillation);
+        iLinearStart = oscillation.iEndFrame;
+
+        // continue from the last extremum of the oscillation
+        while (k < extrema.size() && extrema[k] < iLinearStart)
+            ++k;
+    }
+    CompileLinear(segments, track, iLinearStart, track.size(), fTolerance);
+
+    return kNoError;
+}
+
+Error_t TrajectoryCompiler::ComputeFrameTargets(std::vector<FrameTarget>& frames, const std::vector<MotionSegment>& segments,
+                                                int8_t transpose, float hopSize, Span<float> timeStamps)
+{
+    if (segments.empty() || hopSize <= 0)
+        return kFunctionInvalidArgsError;
+
+    size_t iNumFrames = segments.back().iEndFrame;
+    if (!timeStamps.empty() && timeStamps.size() != iNumFrames)
+        return kFunctionInvalidArgsError;
+
+    frames.resize(iNumFrames);
+    for (const auto& segment : segments) {
+        for (size_t i = segment.iStartFrame; i < segment.iEndFrame; ++i) {
+            float fFrameDuration = hopSize;
+            if (i + 1 < timeStamps.size() && timeStamps[i + 1] > timeStamps[i])
+                fFrameDuration = timeStamps[i + 1] - timeStamps[i];
+
+            auto& frame = frames[i];
+            frame.fFretPosition = Evaluate(segment, (double)i) + transpose;
+            frame.fSlideTarget = GetTarget(segment, i, frame.fSlideSpeed) + transpose;
+            frame.fSlideSpeed /= fFrameDuration;
+            frame.lSlideTarget = Util::fret2Position(frame.fSlideTarget);
+            frame.ulSlideVelocity = Util::SlideVelocity(frame.fSlideTarget, frame.fSlideSpeed);
+        }
+    }
+
+    return kNoError;
+}
+
+float TrajectoryCompiler::Evaluate(const MotionSegment& segment, double fFrame)
+{
+    auto fOffset = fFrame - (double)segment.iStartFrame;
+    switch (segment.type) {
+        case MotionSegment::Ramp: {
+            auto fLength = (double)(segment.iEndFrame - 1 - segment.iStartFrame);
+            if (fLength <= 0)
+                return segment.fStart;
+            return (float)(segment.fStart + (segment.fEnd - segment.fStart) * fOffset / fLength);
+        }
+
+        case MotionSegment::Oscillation:
+            return (float)(segment.fCenter + segment.fDepth * std::cos(M_PI * fOffset / segment.fHalfPeriod));
+
+        case MotionSegment::Hold:
+        default:
+            return segment.fStart;
+    }
+}
+
+float TrajectoryCompiler::GetSlope(const MotionSegment& segment, double fFrame)
+{
+    auto fOffset = fFrame - (double)segment.iStartFrame;
+    switch (segment.type) {
+        case MotionSegment::Ramp: {
+            auto fLength = (double)(segment.iEndFrame - 1 - segment.iStartFrame);
+            if (fLength <= 0)
+                return 0;
+            return (float)((segment.fEnd - segment.fStart) / fLength);
+        }
+
+        case MotionSegment::Oscillation:
+            return (float)(-segment.fDepth * M_PI / segment.fHalfPeriod * std::sin(M_PI * fOffset / segment.fHalfPeriod));
+
+        case MotionSegment::Hold:
+        default:
+            return 0;
+    }
+}
+
+float TrajectoryCompiler::GetTarget(const MotionSegment& segment, size_t iFrame, float& fSpeed)
+{
+    switch (segment.type) {
+        case MotionSegment::Ramp:
+            fSpeed = std::abs(GetSlope(segment, (double)iFrame));
+            return segment.fEnd;
+
+        case MotionSegment::Oscillation: {
+            auto fHalfPeriods = std::floor((double)(iFrame - segment.iStartFrame) / segment.fHalfPeriod) + 1;
+            auto fTurn = std::min(segment.iStartFrame + fHalfPeriods * segment.fHalfPeriod, (double)(segment.iEndFrame - 1));
+            fSpeed = 2 * std::abs(segment.fDepth) / segment.fHalfPeriod;
+            return Evaluate(segment, fTurn);
+        }
+
+        case MotionSegment::Hold:
+        default:
+            fSpeed = 0;
+            return segment.fStart;
+    }
+}
+
+void TrajectoryCompiler::FillRests(std::vector<float>& track, Span<float> pitches)
+{
+    // Frames before the first note hold the first note's position (same as Hathaani::Perform)
+    float fPosition = 0;
+    for (float pitch : pitches) {
+        if (pitch > 0) {
+            fPosition = pitch;
+            break;
+        }
+    }
+
+    track.resize(pitches.size());
+    for (size_t i = 0; i < pitches.size(); ++i) {
+        if (pitches[i] >= 0)
+            fPosition = pitches[i];
+        track[i] = fPosition;
+    }
+}
+
+void TrajectoryCompiler::FindExtrema(std::vector<size_t>& extrema, const std::vector<float>& track, float fHysteresis)
+{
+    // Alternating peaks and troughs, ignoring reversals smaller than fHysteresis
+    extrema.clear();
+    int iDirection = 0;
+    size_t iMax = 0, iMin = 0;
+    for (size_t i = 1; i < track.size(); ++i) {
+        if (track[i] > track[iMax])
+            iMax = i;
+        if (track[i] < track[iMin])
+            iMin = i;
+
+        if (iDirection >= 0 && track[iMax] - track[i] > fHysteresis) {
+            extrema.push_back(iMax);
+            iDirection = -1;
+            iMax = iMin = i;
+        } else if (iDirection <= 0 && track[i] - track[iMin] > fHysteresis) {
+            extrema.push_back(iMin);
+            iDirection = 1;
+            iMax = iMin = i;
+        }
+    }
+}
+
+bool TrajectoryCompiler::FitOscillation(MotionSegment& segment, const std::vector<float>& track, const std::vector<size_t>& extrema,
+                                        size_t iFirst, size_t iLast, float fTolerance)
+{
+    // Extrema alternate, so every other one is a peak (or trough) like the first
+    double fFirstSum = 0, fSecondSum = 0;
+    int iNumFirst = 0, iNumSecond = 0;
+    for (size_t k = iFirst; k <= iLast; ++k) {
+        if ((k - iFirst) % 2 == 0) {
+            fFirstSum += track[extrema[k]];
+            ++iNumFirst;
+        } else {
+            fSecondSum += track[extrema[k]];
+            ++iNumSecond;
+        }
+    }
+    auto fFirst = fFirstSum / iNumFirst;
+    auto fSecond = fSecondSum / iNumSecond;
+
+    segment.type = MotionSegment::Oscillation;
+    segment.iStartFrame = extrema[iFirst];
+    segment.iEndFrame = extrema[iLast] + 1;
+    segment.fCenter = (float)((fFirst + fSecond) / 2);
+    segment.fDepth = (float)((fFirst - fSecond) / 2);
+    segment.fHalfPeriod = (float)(extrema[iLast] - extrema[iFirst]) / (float)(iLast - iFirst);
+    segment.fStart = Evaluate(segment, (double)segment.iStartFrame);
+    segment.fEnd = Evaluate(segment, (double)(segment.iEndFrame - 1));
+
+    for (size_t i = segment.iStartFrame; i < segment.iEndFrame; ++i) {
+        if (std::abs(track[i] - Evaluate(segment, (double)i)) > fTolerance)
+            return false;
+    }
+    return true;
+}
+
+void TrajectoryCompiler::CompileLinear(std::vector<MotionSegment>& segments, const std::vector<float>& track,
+                                       size_t iStart, size_t iEnd, float fTolerance)
+{
+    size_t i = iStart;
+    while (i < iEnd) {
+        // Longest hold: all values within a band of 2 * tolerance
+        float fLow = track[i], fHigh = track[i];
+        size_t iHoldEnd = i + 1;
+        while (iHoldEnd < iEnd && std::max(fHigh, track[iHoldEnd]) - std::min(fLow, track[iHoldEnd]) <= 2 * fTolerance) {
+            fLow = std::min(fLow, track[iHoldEnd]);
+            fHigh = std::max(fHigh, track[iHoldEnd]);
+            ++iHoldEnd;
+        }
+
+        // Longest ramp from track[i] (swinging door: narrow the range of feasible slopes)
+        double fSlopeLow = -std::numeric_limits<double>::max();
+        double fSlopeHigh = std::numeric_limits<double>::max();
+        size_t iRampEnd = i + 1;
+        while (iRampEnd < iEnd) {
+            auto fDist = (double)(iRampEnd - i);
+            auto fLow = std::max(fSlopeLow, (track[iRampEnd] - fTolerance - track[i]) / fDist);
+            auto fHigh = std::min(fSlopeHigh, (track[iRampEnd] + fTolerance - track[i]) / fDist);
+            if (fLow > fHigh)
+                break;
+            fSlopeLow = fLow;
+            fSlopeHigh = fHigh;
+            ++iRampEnd;
+        }
+
+        MotionSegment segment;
+        segment.iStartFrame = i;
+        if (iHoldEnd >= iRampEnd) {
+            segment.type = MotionSegment::Hold;
+            segment.iEndFrame = iHoldEnd;
+            segment.fStart = segment.fEnd = (fLow + fHigh) / 2;
+        } else {
+            auto fLength = (double)(iRampEnd - 1 - i);
+            auto fSlope = std::clamp((track[iRampEnd - 1] - track[i]) / fLength, fSlopeLow, fSlopeHigh);
+            segment.type = MotionSegment::Ramp;
+            segment.iEndFrame = iRampEnd;
+            segment.fStart = track[i];
+            segment.fEnd = (float)(track[i] + fSlope * fLength);
+        }
+        segments.push_back(segment);
+        i = segment.iEndFrame;
+    }
+}
@@ -6,32 +6,76 @@
 
 #include "Hathaani.h"
 #include "PitchFileParser.h"
+#include "Score.h"
+#include "ScoreCache.h"
 #include "Logger.h"
+#include "Trace.h"
 
 const int8_t TRANSPOSE = 1;
+const char* TRACE_FILE = "trace.csv";
 
 //#define SET_HOME
  
 using namespace std;
 
 int main(int argc, char **argv) {
-    Logger::init(Logger::info);
+    Logger::init(Logger::info, Logger::async);
+    // Writes out the queued messages on every return. Declared first, so everything that logs is gone by then.
+    struct LoggerGuard {
+        ~LoggerGuard() { Logger::shutdown(); }
+    } loggerGuard;
+    Trace::init();
     Error_t lResult = kNoError;
 
     std::vector<float> pitches, amplitude;
     std::vector<size_t> bowChangeIdx;
+    std::vector<float> timeStamps;
+    std::vector<uint8_t> bowChangeFlags;
+    float hopSize = PITCH_HOP_SIZE_US * 1e-6f;
+
+    // Scores go through the cache: a restart on the same piece maps the preprocessed score and
+    // trajectory instead of parsing and compiling again. Binary scores (see ScoreConverter) are
+    // mapped in place.
+    BinaryScore binaryScore;
+    ScoreCache scoreCache;
+    bool bCached = false;
+    Score score;
 
     if (argc > 1)
     {
-        PitchFileParser pitchFileParser(argv[1]);
-        lResult = pitchFileParser.parseJson(pitches, bowChangeIdx, amplitude);
-        if (lResult != kNoError)
+        lResult = scoreCache.Load(argv[1], binaryScore);
+        if (lResult == kNoError)
+        {
+            bCached = true;
+            score = binaryScore.GetScore();
+            cout << (scoreCache.isHit() ? "Loaded " : "Cached ") << score.pitches.size() << " frames\n";
+        }
+        else if (BinaryScore::IsBinaryScore(argv[1]))
         {
-            LOG_ERROR("{} - {}", PitchFileParser::kName, lResult);
-            CUtil::PrintError(PitchFileParser::kName, lResult);
+            LOG_ERROR("{} - {}", ScoreCache::kName, lResult);
+            CUtil::PrintError(ScoreCache::kName, lResult);
             return 1;
         }
-        cout << "Read pitches successfully!\n";
+        else
+        {
+            LOG_WARN("{} - {}, parsing without the cache", ScoreCache::kName, lResult);
+            PitchFileParser pitchFileParser(argv[1]);
+            lResult = pitchFileParser.parseJson(pitches, bowChangeIdx, amplitude, hopSize, timeStamps);
+            if (lResult != kNoError)
+            {
+                LOG_ERROR("{} - {}", PitchFileParser::kName, lResult);
+                CUtil::PrintError(PitchFileParser::kName, lResult);
+                return 1;
+            }
+            cout << "Read pitches successfully!\n";
+
+            Score::FlagBowChanges(bowChangeFlags, bowChangeIdx, pitches.size());
+            score.pitches = pitches;
+            score.amplitude = amplitude;
+            score.bowChange = bowChangeFlags;
+            score.timeStamps = timeStamps;
+            score.hopSize = hopSize;
+        }
     }
 
     Hathaani hathaani;
@@ -44,6 +88,16 @@ int main(int argc, char **argv) {
     return 0;
 #endif //SET_HOME
 
+    ScoreTrajectory trajectory;
+    if (!bCached || scoreCache.LoadTrajectory(trajectory, TRANSPOSE) != kNoError) {
+        if ((lResult = Hathaani::CompileTrajectory(trajectory, score, TRANSPOSE)) != kNoError) {
+            Hathaani::LogError("CompileTrajectory", lResult, 0);
+            return EXIT_FAILURE;
+        }
+        if (bCached && (lResult = scoreCache.StoreTrajectory(trajectory)) != kNoError)
+            LOG_WARN("{} - {}, trajectory not cached", ScoreCache::kName, lResult);
+    }
+
 //    lResult = hathaani.ApplyRosin(10);
 //    if (lResult != kNoError) {
 //        Hathaani::LogError("ApplyRosin", lResult, 0);
@@ -65,7 +119,9 @@ int main(int argc, char **argv) {
 //        amplitude[i] = i * 1.f / amplitude.size();
 //    }
 //
-    if ((lResult = hathaani.Perform(pitches, bowChangeIdx, amplitude, 0.25, TRANSPOSE)) != kNoError) {
+    lResult = hathaani.Perform(score, trajectory, 0.25, TRANSPOSE);
+    Trace::dump(TRACE_FILE);
+    if (lResult != kNoError) {
         LOG_ERROR("Perform error");
         return EXIT_FAILURE;
     }
@@ -0,0 +1,83 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_DOMSCOREPARSER_H
+#define HATHAANI_DOMSCOREPARSER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MyDefinitions.h"
+#include "rapidjson/document.h"
+
+/* PitchFileParser::parseJson as it was before the SAX reader: the whole file in a string, parsed into a
+ * rapidjson DOM and copied out. Kept as the reference for ParserTest and ParserBench. The asserts on
+ * missing or mistyped members return kFileParseError instead, and bow entries have to be non-negative
+ * integers, which is what the SAX reader enforces. */
+inline Error_t parseScoreDom(const std::string& filePath, std::vector<float>& pitches, std::vector<size_t>& bowChanges,
+                             std::vector<float>& amplitude, float& hopSize, std::vector<float>& timeStamps)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+        return kFileOpenError;
+
+    using namespace rapidjson;
+    Document map;
+    std::string strObj;
+    std::getline(file, strObj, '\0');
+
+    if (map.Parse(strObj.c_str()).HasParseError() || !map.IsObject())
+        return kFileParseError;
+
+    auto readFloats = [&map](const char* name, std::vector<float>& values) {
+        if (!map.HasMember(name) || !map[name].IsArray())
+            return false;
+        const Value& array = map[name];
+        values.resize(array.Size());
+        for (SizeType i = 0; i < array.Size(); ++i) {
+            if (!array[i].IsNumber())
+                return false;
+            values[i] = array[i].GetFloat();
+        }
+        return true;
+    };
+
+    if (!readFloats("pitch", pitches))
+        return kFileParseError;
+
+    if (!map.HasMember("bow") || !map["bow"].IsArray())
+        return kFileParseError;
+    const Value& bow = map["bow"];
+    bowChanges.resize(bow.Size());
+    for (SizeType i = 0; i < bow.Size(); ++i) {
+        if (!bow[i].IsUint64())
+            return kFileParseError;
+        bowChanges[i] = bow[i].GetUint64();
+    }
+
+    if (!readFloats("amplitude", amplitude))
+        return kFileParseError;
+
+    hopSize = PITCH_HOP_SIZE_US * 1e-6f;
+    if (map.HasMember("hop")) {
+        if (!map["hop"].IsNumber() || !(map["hop"].GetFloat() >= MIN_HOP_SIZE && map["hop"].GetFloat() <= MAX_HOP_SIZE))
+            return kFileParseError;
+        hopSize = map["hop"].GetFloat();
+    }
+
+    timeStamps.clear();
+    if (map.HasMember("time")) {
+        if (!readFloats("time", timeStamps) || timeStamps.size() != pitches.size())
+            return kFileParseError;
+        for (size_t i = 1; i < timeStamps.size(); ++i) {
+            if (timeStamps[i] < timeStamps[i - 1])
+                return kFileParseError;
+        }
+    }
+
+    return kNoError;
+}
+
+#endif //HATHAANI_DOMSCOREPARSER_H
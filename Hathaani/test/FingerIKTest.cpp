@@ -0,0 +1,104 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Finger::calcIKInterpolated against Finger::calcIK over the whole joint angle grid at 20 points per mm.
+// The interpolated angles have to stay within the 0.011 deg documented in Finger.h, and be the solved
+// ones outside of the grid. A target out of reach has to fail and leave the previous angles untouched.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+#include "Finger.h"
+
+namespace {
+    const int kPointsPerMm = 20;
+    const double kBoundDeg = 0.011;
+
+    int g_iNumFailures = 0;
+
+    double rad2deg(float fAngle) {
+        return fAngle * 180. / M_PI;
+    }
+}
+
+int main() {
+    Finger finger;
+    float fTheta1, fTheta2, fExpected1, fExpected2;
+
+    double dMaxError = 0;
+    float fMaxErrorX = 0, fMaxErrorY = 0;
+    int iNumUnreachable = 0;
+    for (int i = 0; i <= (int)(Finger::kGridMaxX - Finger::kGridMinX) * kPointsPerMm; i++) {
+        for (int k = 0; k <= (int)(Finger::kGridMaxY - Finger::kGridMinY) * kPointsPerMm; k++) {
+            float x = Finger::kGridMinX + (float)i / kPointsPerMm;
+            float y = Finger::kGridMinY + (float)k / kPointsPerMm;
+            if (finger.calcIK(x, y) != kNoError) {
+                iNumUnreachable++;
+                continue;
+            }
+            finger.getDriveAngles(fExpected1, fExpected2);
+
+            if (finger.calcIKInterpolated(x, y) != kNoError) {
+                std::printf("FAIL calcIKInterpolated(%g, %g) failed where calcIK did not\n", x, y);
+                g_iNumFailures++;
+                continue;
+            }
+            finger.getDriveAngles(fTheta1, fTheta2);
+
+            double dError = std::max(std::abs(rad2deg(fTheta1) - rad2deg(fExpected1)), std::abs(rad2deg(fTheta2) - rad2deg(fExpected2)));
+            if (dError > dMaxError) {
+                dMaxError = dError;
+                fMaxErrorX = x;
+                fMaxErrorY = y;
+            }
+        }
+    }
+    std::printf("max error %.4g deg at (%g, %g), bound %g deg, %d targets out of reach\n", dMaxError, fMaxErrorX, fMaxErrorY, kBoundDeg, iNumUnreachable);
+    if (dMaxError > kBoundDeg) {
+        std::printf("FAIL max error %g deg at (%g, %g)\n", dMaxError, fMaxErrorX, fMaxErrorY);
+        g_iNumFailures++;
+    }
+
+    for (float y : {(float)FINGER_ON, (float)FINGER_OFF}) {
+        if (finger.calcIK(-153, y) != kNoError) {
+            std::printf("FAIL calcIK(-153, %g) failed\n", y);
+            g_iNumFailures++;
+        }
+    }
+
+    // outside of the grid, but still in reach
+    for (float x : {Finger::kGridMinX - 2, Finger::kGridMaxX + 2}) {
+        if (finger.calcIK(x, FINGER_ON) != kNoError) {
+            std::printf("FAIL calcIK(%g, %d) failed\n", x, FINGER_ON);
+            g_iNumFailures++;
+            continue;
+        }
+        finger.getDriveAngles(fExpected1, fExpected2);
+        finger.calcIKInterpolated(x, FINGER_ON);
+        finger.getDriveAngles(fTheta1, fTheta2);
+        if (fTheta1 != fExpected1 || fTheta2 != fExpected2) {
+            std::printf("FAIL calcIKInterpolated(%g, %d) outside of the grid is not calcIK\n", x, FINGER_ON);
+            g_iNumFailures++;
+        }
+    }
+
+    finger.calcIK(-153, FINGER_ON);
+    finger.getDriveAngles(fExpected1, fExpected2);
+    for (auto target : {std::pair<float, float>(0, 1000), {-153, 500}, {-200, 60}}) {
+        if (finger.calcIK(target.first, target.second) == kNoError) {
+            std::printf("FAIL calcIK(%g, %g) is out of reach but succeeded\n", target.first, target.second);
+            g_iNumFailures++;
+        }
+        finger.getDriveAngles(fTheta1, fTheta2);
+        if (fTheta1 != fExpected1 || fTheta2 != fExpected2) {
+            std::printf("FAIL calcIK(%g, %g) failed but changed the angles\n", target.first, target.second);
+            g_iNumFailures++;
+        }
+    }
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
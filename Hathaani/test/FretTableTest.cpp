@@ -0,0 +1,69 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Util::FretLength (table) against Util::FretLengthExact over the whole table at 1000 points per fret.
+// The error has to stay within the interpolation bound documented in Util.h plus one float ulp of
+// the longest entry (the rounding of the entries and of the interpolated value). Table nodes have to
+// be the exact lengths rounded to float, and frets outside the table (including kFretTableMaxFret
+// itself) the exact lengths.
+
+#include <cmath>
+#include <cstdio>
+
+#include "Util.h"
+
+namespace {
+    const int kPointsPerFret = 1000;
+
+    int g_iNumFailures = 0;
+}
+
+int main() {
+    const double kInterpolationBound = SCALE_LENGTH * std::pow(M_LN2 / 12, 2) / (8. * Util::kFretTableResolution * Util::kFretTableResolution);
+    const auto fLongest = (float)Util::FretLengthExact(Util::kFretTableMaxFret);
+    const double kRoundingBound = std::nextafter(fLongest, 2 * fLongest) - fLongest;
+
+    if (kInterpolationBound > 3.4e-5) {
+        std::printf("FAIL interpolation bound %g mm, Util.h documents 3.4e-5 mm\n", kInterpolationBound);
+        g_iNumFailures++;
+    }
+
+    double dMaxError = 0;
+    float fMaxErrorFret = 0;
+    for (int k = 0; k <= Util::kFretTableMaxFret * kPointsPerFret; k++) {
+        float fFret = (float)k / kPointsPerFret;
+        double dError = std::abs(Util::FretLength(fFret) - Util::FretLengthExact(fFret));
+        if (dError > dMaxError) {
+            dMaxError = dError;
+            fMaxErrorFret = fFret;
+        }
+    }
+    std::printf("max error %.3g mm at fret %.3f, bound %.3g + %.3g mm\n", dMaxError, fMaxErrorFret, kInterpolationBound, kRoundingBound);
+    if (dMaxError > kInterpolationBound + kRoundingBound) {
+        std::printf("FAIL max error %g mm at fret %g\n", dMaxError, fMaxErrorFret);
+        g_iNumFailures++;
+    }
+
+    for (int i = 0; i < Util::kFretTableSize - 1; i++) {
+        float fFret = (float)i / Util::kFretTableResolution;
+        if (Util::FretLength(fFret) != (float)Util::FretLengthExact(fFret)) {
+            std::printf("FAIL node %d (fret %g): %.9g, expected %.9g\n", i, fFret, Util::FretLength(fFret), (float)Util::FretLengthExact(fFret));
+            g_iNumFailures++;
+        }
+    }
+
+    for (float fFret : {-2.f, -1e-3f, (float)Util::kFretTableMaxFret, 26.f}) {
+        if (Util::FretLength(fFret) != Util::FretLengthExact(fFret)) {
+            std::printf("FAIL fret %g outside the table: %.9g, expected %.9g\n", fFret, Util::FretLength(fFret), Util::FretLengthExact(fFret));
+            g_iNumFailures++;
+        }
+    }
+    if (!std::isnan(Util::FretLength(NAN))) {
+        std::printf("FAIL FretLength(NaN) is not NaN\n");
+        g_iNumFailures++;
+    }
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
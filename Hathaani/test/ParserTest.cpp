@@ -0,0 +1,206 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// PitchFileParser::parseJson (SAX) against the DOM parser it replaced (DomScoreParser.h): every
+// Examples/*.json, every prefix of them cut at random points, hand written edge cases with their
+// expected result, and random single byte edits of a small score. Both parsers have to agree on the
+// error code and, when they succeed, on every value.
+//
+//   ParserTest <Examples directory>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DomScoreParser.h"
+#include "PitchFileParser.h"
+
+namespace {
+    int g_iNumFailures = 0;
+
+    struct ParsedScore {
+        Error_t err = kNoError;
+        std::vector<float> pitches, amplitude, timeStamps;
+        std::vector<size_t> bowChanges;
+        float hopSize = 0;
+
+        bool operator==(const ParsedScore& other) const {
+            if (err != other.err)
+                return false;
+            if (err != kNoError)
+                return true;
+            return pitches == other.pitches && amplitude == other.amplitude && timeStamps == other.timeStamps &&
+                   bowChanges == other.bowChanges && hopSize == other.hopSize;
+        }
+    };
+
+    ParsedScore parseSax(const std::string& filePath) {
+        ParsedScore score;
+        PitchFileParser parser(filePath);
+        score.err = parser.parseJson(score.pitches, score.bowChanges, score.amplitude, score.hopSize, score.timeStamps);
+        return score;
+    }
+
+    ParsedScore parseDom(const std::string& filePath) {
+        ParsedScore score;
+        score.err = parseScoreDom(filePath, score.pitches, score.bowChanges, score.amplitude, score.hopSize, score.timeStamps);
+        return score;
+    }
+
+    std::string writeTemp(const std::string& text) {
+        static int iCount = 0;
+        auto path = std::filesystem::temp_directory_path() / ("ParserTest_" + std::to_string(iCount++ % 8) + ".json");
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+        return path.string();
+    }
+
+    /* both parsers agree; returns the SAX result */
+    ParsedScore checkEquivalent(const std::string& filePath, const std::string& label) {
+        auto sax = parseSax(filePath);
+        auto dom = parseDom(filePath);
+        if (!(sax == dom)) {
+            std::printf("FAIL %s: SAX error %d, %zu frames, DOM error %d, %zu frames\n", label.c_str(), sax.err,
+                        sax.pitches.size(), dom.err, dom.pitches.size());
+            g_iNumFailures++;
+        }
+        return sax;
+    }
+
+    void checkText(const std::string& text, Error_t expected, const std::string& label) {
+        auto sax = checkEquivalent(writeTemp(text), label);
+        if (sax.err != expected) {
+            std::printf("FAIL %s: error %d, expected %d\n", label.c_str(), sax.err, expected);
+            g_iNumFailures++;
+        }
+    }
+
+    void testExamples(const std::string& examplesDir, std::mt19937& rng) {
+        std::vector<std::filesystem::path> files;
+        for (auto& entry : std::filesystem::directory_iterator(examplesDir)) {
+            if (entry.path().extension() == ".json")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::printf("FAIL no scores in %s\n", examplesDir.c_str());
+            g_iNumFailures++;
+        }
+
+        for (auto& path : files) {
+            auto sax = checkEquivalent(path.string(), path.filename().string());
+            if (sax.err != kNoError || sax.pitches.empty() || sax.pitches.size() != sax.amplitude.size()) {
+                std::printf("FAIL %s: error %d, %zu pitches, %zu amplitudes\n", path.filename().c_str(), sax.err,
+                            sax.pitches.size(), sax.amplitude.size());
+                g_iNumFailures++;
+            }
+
+            // cut anywhere before the closing brace
+            std::ifstream file(path, std::ios::binary);
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            std::uniform_int_distribution<size_t> cut(0, text.rfind('}') - 1);
+            for (int i = 0; i < 20; i++) {
+                auto iLength = (i == 0) ? text.rfind('}') : cut(rng);
+                checkText(text.substr(0, iLength), kFileParseError, path.filename().string() + " cut at " + std::to_string(iLength));
+            }
+        }
+    }
+
+    void testEdgeCases() {
+        const std::string kArrays = R"("pitch": [1, 2.5, 3], "bow": [0, 2], "amplitude": [0.1, 0.2, 0.3])";
+
+        checkText("{" + kArrays + "}", kNoError, "minimal");
+        checkText(R"({"amplitude": [0.1, 0.2, 0.3], "time": [0, 0.01, 0.02], "bow": [0, 2], "hop": 0.01, "pitch": [1, 2.5, 3]})",
+                  kNoError, "key order");
+        checkText(R"({"meta": {"name": "x", "list": [1, {"a": [null, true]}]}, "notes": ["S", "R"], )" + kArrays + "}",
+                  kNoError, "unknown members");
+        checkText("{" + kArrays + R"(, "pitch": [7], "bow": [-1], "hop": "x", "hop": 0.02})", kFileParseError, "duplicate invalid hop");
+        checkText("{" + kArrays + R"(, "hop": 0.02, "hop": "x", "pitch": [7], "bow": [-1]})", kNoError, "duplicate keys");
+        checkText("{" + kArrays + R"(, "pitch": [1], "time": [0, 1, 1], "time": [2]})", kNoError, "duplicate time");
+
+        auto sax = parseSax(writeTemp("{" + kArrays + R"(, "hop": 0.02, "hop": 5, "pitch": [7]})"));
+        if (sax.pitches.size() != 3 || sax.hopSize != 0.02f) {
+            std::printf("FAIL duplicate keys: the first occurrence has to win\n");
+            g_iNumFailures++;
+        }
+
+        for (auto hop : {"0", "-0.01", "\"0.01\"", "[0.01]", "{}", "null", "1e-7", "0.0009", "10.5", "1e30"})
+            checkText("{" + kArrays + R"(, "hop": )" + hop + "}", kFileParseError, std::string("bad hop ") + hop);
+        checkText("{" + kArrays + R"(, "hop": 1})", kNoError, "integer hop");
+        for (auto hop : {"0.001", "10"})
+            checkText("{" + kArrays + R"(, "hop": )" + hop + "}", kNoError, std::string("hop at the limit ") + hop);
+
+        checkText("{" + kArrays + R"(, "time": [0, 0.02, 0.01]})", kFileParseError, "decreasing time");
+        checkText("{" + kArrays + R"(, "time": [0, 0.01, 0.01]})", kNoError, "repeated time");
+        checkText("{" + kArrays + R"(, "time": [0, 0.01]})", kFileParseError, "short time");
+        checkText("{" + kArrays + R"(, "time": 0})", kFileParseError, "time not an array");
+
+        checkText(R"({"pitch": [1], "bow": [0]})", kFileParseError, "missing amplitude");
+        checkText(R"({"pitch": [1], "amplitude": [0]})", kFileParseError, "missing bow");
+        checkText(R"({"bow": [0], "amplitude": [0]})", kFileParseError, "missing pitch");
+        checkText(R"({"pitch": [1], "bow": [0.5], "amplitude": [0]})", kFileParseError, "fractional bow");
+        checkText(R"({"pitch": [1], "bow": [-1], "amplitude": [0]})", kFileParseError, "negative bow");
+        checkText(R"({"pitch": [1, "2"], "bow": [0], "amplitude": [0]})", kFileParseError, "string pitch");
+        checkText(R"({"pitch": [[1]], "bow": [0], "amplitude": [0]})", kFileParseError, "nested pitch");
+        checkText(R"({"pitch": 1, "bow": [0], "amplitude": [0]})", kFileParseError, "pitch not an array");
+
+        checkText("", kFileParseError, "empty file");
+        checkText("[" + kArrays + "]", kFileParseError, "root array");
+        checkText("{" + kArrays + "} {}", kFileParseError, "trailing value");
+
+        PitchFileParser parser("/nonexistent/score.json");
+        std::vector<float> pitches, amplitude;
+        std::vector<size_t> bowChanges;
+        if (parser.parseJson(pitches, bowChanges, amplitude) != kFileOpenError) {
+            std::printf("FAIL missing file: expected kFileOpenError\n");
+            g_iNumFailures++;
+        }
+    }
+
+    /* single byte deletions, insertions and replacements of a small score, from JSON punctuation and digits */
+    void testMutations(std::mt19937& rng) {
+        const std::string kScore = R"({"pitch": [1, 2.5, 3], "x": [{"y": 1}], "bow": [0, 2], "amplitude": [0.1, 0.2, 0.3], "hop": 0.01, "time": [0, 0.01, 0.02]})";
+        const std::string kAlphabet = "{}[],:\" -.0123456789e";
+        std::uniform_int_distribution<size_t> position(0, kScore.size() - 1);
+        std::uniform_int_distribution<size_t> character(0, kAlphabet.size() - 1);
+        std::uniform_int_distribution<int> operation(0, 2);
+
+        for (int i = 0; i < 2000; i++) {
+            std::string text = kScore;
+            auto iPos = position(rng);
+            auto c = kAlphabet[character(rng)];
+            switch (operation(rng)) {
+                case 0:
+                    text.erase(iPos, 1);
+                    break;
+                case 1:
+                    text.insert(iPos, 1, c);
+                    break;
+                default:
+                    text[iPos] = c;
+                    break;
+            }
+            checkEquivalent(writeTemp(text), "mutation " + text);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <Examples directory>\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1);
+    testExamples(argv[1], rng);
+    testEdgeCases();
+    testMutations(rng);
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
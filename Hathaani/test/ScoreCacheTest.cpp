@@ -0,0 +1,171 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// ScoreCache on a copy of an example score in a fresh cache directory: the first Load misses and the
+// second hits with the same score, an edited score misses with a new key, and a damaged entry is
+// rebuilt (the .hsc by Load, the .trj by storing it again after LoadTrajectory refused it, as main does).
+//
+//   ScoreCacheTest <Examples directory>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "PitchFileParser.h"
+#include "ScoreCache.h"
+
+namespace {
+    const int8_t kTranspose = 2;
+
+    int g_iNumFailures = 0;
+
+    void check(bool bCondition, const std::string& label) {
+        if (!bCondition) {
+            std::printf("FAIL %s\n", label.c_str());
+            g_iNumFailures++;
+        }
+    }
+
+    template <typename T>
+    bool isEqual(const std::vector<T>& a, const std::vector<T>& b) {
+        // the records are stored as raw bytes, so they have to come back byte for byte
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool isEqual(const ScoreTrajectory& a, const ScoreTrajectory& b) {
+        return isEqual(a.segments, b.segments) && isEqual(a.pvtPoints, b.pvtPoints) && isEqual(a.frames, b.frames) &&
+               a.transpose == b.transpose;
+    }
+
+    bool isEqual(Span<float> span, const std::vector<float>& expected) {
+        return span.size() == expected.size() && std::equal(span.begin(), span.end(), expected.begin());
+    }
+
+    std::vector<std::filesystem::path> findEntries(const std::filesystem::path& directory, const std::string& extension) {
+        std::vector<std::filesystem::path> entries;
+        for (auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.path().extension() == extension)
+                entries.push_back(entry.path());
+        }
+        return entries;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << bytes;
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return {(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()};
+    }
+
+    /* What main stores: the compiled score plus some IPM points (their computation needs the drive library) */
+    Error_t compile(ScoreTrajectory& trajectory, const Score& score) {
+        auto err = TrajectoryCompiler::Compile(trajectory.segments, score.pitches, score.hopSize);
+        if (err != kNoError)
+            return err;
+        trajectory.transpose = kTranspose;
+        trajectory.pvtPoints.clear();
+        for (const auto& segment : trajectory.segments)
+            trajectory.pvtPoints.push_back({Util::fret2Position(segment.fStart + kTranspose), (long)segment.iStartFrame, 10});
+        return TrajectoryCompiler::ComputeFrameTargets(trajectory.frames, trajectory.segments, kTranspose, score.hopSize, score.timeStamps);
+    }
+
+    void testCache(const std::filesystem::path& examplePath, const std::filesystem::path& workDir) {
+        auto cacheDir = workDir / "cache";
+        auto scorePath = workDir / "score.json";
+        std::filesystem::copy_file(examplePath, scorePath);
+
+        std::vector<float> pitches, amplitude, timeStamps;
+        std::vector<size_t> bowChanges;
+        float hopSize;
+        PitchFileParser parser(scorePath.string());
+        check(parser.parseJson(pitches, bowChanges, amplitude, hopSize, timeStamps) == kNoError, "parse " + examplePath.filename().string());
+
+        ScoreCache cache(cacheDir.string());
+        BinaryScore binaryScore;
+        check(cache.Load(scorePath.string(), binaryScore) == kNoError && !cache.isHit(), "first Load misses");
+        check(cache.Load(scorePath.string(), binaryScore) == kNoError && cache.isHit(), "second Load hits");
+        const auto& score = binaryScore.GetScore();
+        check(isEqual(score.pitches, pitches) && isEqual(score.amplitude, amplitude) && isEqual(score.timeStamps, timeStamps) &&
+              score.hopSize == hopSize, "cached score equals the parsed one");
+
+        ScoreTrajectory trajectory, cached;
+        check(cache.LoadTrajectory(cached, kTranspose) == kFileOpenError, "no trajectory before StoreTrajectory");
+        check(compile(trajectory, score) == kNoError, "compile the trajectory");
+        check(cache.StoreTrajectory(trajectory) == kNoError, "StoreTrajectory");
+        check(cache.LoadTrajectory(cached, kTranspose) == kNoError && isEqual(cached, trajectory), "stored trajectory comes back unchanged");
+        check(cache.LoadTrajectory(cached, kTranspose + 1) == kFileOpenError, "other transposition misses");
+
+        // a damaged trajectory is refused and replaced by storing it again
+        auto trajectories = findEntries(cacheDir, ".trj");
+        check(trajectories.size() == 1, "one trajectory entry");
+        auto trajectoryBytes = readFile(trajectories.at(0));
+        for (size_t iLength : {(size_t)0, (size_t)3, (size_t)40, trajectoryBytes.size() / 2, trajectoryBytes.size() - 1}) {
+            writeFile(trajectories[0], trajectoryBytes.substr(0, iLength));
+            cached = trajectory;
+            check(cache.LoadTrajectory(cached, kTranspose) == kFileParseError, "trajectory truncated to " + std::to_string(iLength) + " bytes is refused");
+        }
+        writeFile(trajectories[0], "XTRJ" + trajectoryBytes.substr(4));
+        check(cache.LoadTrajectory(cached, kTranspose) == kFileParseError, "trajectory with a bad magic is refused");
+        writeFile(trajectories[0], trajectoryBytes + "x");
+        check(cache.LoadTrajectory(cached, kTranspose) == kFileParseError, "trajectory with trailing bytes is refused");
+        check(cache.StoreTrajectory(trajectory) == kNoError, "StoreTrajectory over the damaged entry");
+        check(cache.LoadTrajectory(cached, kTranspose) == kNoError && isEqual(cached, trajectory), "rebuilt trajectory loads");
+
+        // a damaged score entry is rebuilt from the JSON
+        auto scores = findEntries(cacheDir, ".hsc");
+        check(scores.size() == 1, "one score entry");
+        binaryScore.Close();
+        writeFile(scores.at(0), readFile(scores[0]).substr(0, 100));
+        check(cache.Load(scorePath.string(), binaryScore) == kNoError && !cache.isHit(), "truncated score entry misses");
+        check(cache.Load(scorePath.string(), binaryScore) == kNoError && cache.isHit() && isEqual(binaryScore.GetScore().pitches, pitches),
+              "rebuilt score entry hits");
+        check(cache.LoadTrajectory(cached, kTranspose) == kNoError, "trajectory still found after the score entry was rebuilt");
+
+        // an edit changes the key, so neither the score nor its trajectory are found
+        auto text = readFile(scorePath);
+        auto iPitches = text.find("\"pitch\"");
+        check(iPitches != std::string::npos, "score has a pitch member");
+        writeFile(scorePath, text.substr(0, iPitches) + "\"edited\": 1, " + text.substr(iPitches));
+        check(cache.Load(scorePath.string(), binaryScore) == kNoError && !cache.isHit(), "edited score misses");
+        check(findEntries(cacheDir, ".hsc").size() == 2, "edited score gets its own entry");
+        check(cache.LoadTrajectory(cached, kTranspose) == kFileOpenError, "edited score has no trajectory yet");
+        check(cache.Load(scorePath.string(), binaryScore) == kNoError && cache.isHit(), "edited score hits afterwards");
+
+        // a BinaryScore is used in place and only gets its trajectories cached
+        auto binaryPath = workDir / "score.hsc";
+        std::filesystem::copy_file(scores[0], binaryPath);
+        check(cache.Load(binaryPath.string(), binaryScore) == kNoError && cache.isHit(), "BinaryScore file loads");
+        check(findEntries(cacheDir, ".hsc").size() == 2, "BinaryScore file is not copied into the cache");
+        check(cache.StoreTrajectory(trajectory) == kNoError && findEntries(cacheDir, ".trj").size() == 2,
+              "BinaryScore file gets its own trajectory entry");
+
+        check(cache.Load((workDir / "missing.json").string(), binaryScore) == kFileOpenError, "missing score");
+        check(cache.LoadTrajectory(cached, kTranspose) == kNotInitializedError, "no trajectory after a failed Load");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <Examples directory>\n", argv[0]);
+        return 1;
+    }
+
+    auto workDir = std::filesystem::temp_directory_path() / "ScoreCacheTest";
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    testCache(std::filesystem::path(argv[1]) / "Kanada.json", workDir);
+
+    std::filesystem::remove_all(workDir);
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// BinaryScore::Write / Open round trip of every Examples/*.json (and of a score with time stamps),
+// which has to give back every value and the hop size. Damaged files have to be refused by Open:
+// every truncation, a bad magic, another version, a frame count of zero or beyond the file and a hop
+// size out of range. Write has to refuse scores Open could not hand out.
+//
+//   ScoreTest <Examples directory>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "PitchFileParser.h"
+#include "Score.h"
+
+namespace {
+    // header fields, see the layout in Score.h
+    const size_t kVersionOffset = 4;
+    const size_t kHopSizeOffset = 12;
+    const size_t kNumFramesOffset = 16;
+
+    int g_iNumFailures = 0;
+
+    /* Score with its own storage */
+    struct ScoreData {
+        std::vector<float> pitches, amplitude, timeStamps;
+        std::vector<uint8_t> bowChange;
+        float hopSize = PITCH_HOP_SIZE_US * 1e-6f;
+
+        [[nodiscard]] Score get() const {
+            Score score;
+            score.pitches = pitches;
+            score.amplitude = amplitude;
+            score.bowChange = bowChange;
+            score.timeStamps = timeStamps;
+            score.hopSize = hopSize;
+            return score;
+        }
+    };
+
+    template <typename T>
+    bool isEqual(Span<T> span, const std::vector<T>& expected) {
+        return span.size() == expected.size() && std::equal(span.begin(), span.end(), expected.begin());
+    }
+
+    std::string tempPath(const std::string& name) {
+        return (std::filesystem::temp_directory_path() / ("ScoreTest_" + name + ".hsc")).string();
+    }
+
+    std::string readFile(const std::string& filePath) {
+        std::ifstream file(filePath, std::ios::binary);
+        return {(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()};
+    }
+
+    std::string writeFile(const std::string& name, const std::string& bytes) {
+        auto filePath = tempPath(name);
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        file << bytes;
+        return filePath;
+    }
+
+    void checkRoundTrip(const ScoreData& data, const std::string& label) {
+        auto filePath = tempPath("roundtrip");
+        auto err = BinaryScore::Write(filePath, data.get());
+        if (err != kNoError) {
+            std::printf("FAIL %s: Write error %d\n", label.c_str(), err);
+            g_iNumFailures++;
+            return;
+        }
+
+        BinaryScore binaryScore;
+        if ((err = binaryScore.Open(filePath)) != kNoError) {
+            std::printf("FAIL %s: Open error %d\n", label.c_str(), err);
+            g_iNumFailures++;
+            return;
+        }
+
+        const auto& score = binaryScore.GetScore();
+        if (!isEqual(score.pitches, data.pitches) || !isEqual(score.amplitude, data.amplitude) ||
+            !isEqual(score.bowChange, data.bowChange) || !isEqual(score.timeStamps, data.timeStamps) ||
+            score.hopSize != data.hopSize) {
+            std::printf("FAIL %s: the mapped score differs from the written one\n", label.c_str());
+            g_iNumFailures++;
+        }
+        for (auto pColumn : {(const void*)score.pitches.data(), (const void*)score.amplitude.data(), (const void*)score.bowChange.data()}) {
+            if (reinterpret_cast<uintptr_t>(pColumn) % BinaryScore::kAlignment != 0) {
+                std::printf("FAIL %s: column not aligned to %zu bytes\n", label.c_str(), BinaryScore::kAlignment);
+                g_iNumFailures++;
+            }
+        }
+    }
+
+    void checkRefused(const std::string& bytes, const std::string& label) {
+        BinaryScore binaryScore;
+        if (binaryScore.Open(writeFile("damaged", bytes)) == kNoError) {
+            std::printf("FAIL %s: Open accepted it\n", label.c_str());
+            g_iNumFailures++;
+        }
+    }
+
+    template <typename T>
+    std::string withField(std::string bytes, size_t iOffset, T value) {
+        std::memcpy(&bytes[iOffset], &value, sizeof(value));
+        return bytes;
+    }
+
+    void testExamples(const std::string& examplesDir) {
+        std::vector<std::filesystem::path> files;
+        for (auto& entry : std::filesystem::directory_iterator(examplesDir)) {
+            if (entry.path().extension() == ".json")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::printf("FAIL no scores in %s\n", examplesDir.c_str());
+            g_iNumFailures++;
+        }
+
+        for (auto& path : files) {
+            ScoreData data;
+            std::vector<size_t> bowChanges;
+            PitchFileParser parser(path.string());
+            auto err = parser.parseJson(data.pitches, bowChanges, data.amplitude, data.hopSize, data.timeStamps);
+            if (err != kNoError) {
+                std::printf("FAIL %s: parse error %d\n", path.filename().c_str(), err);
+                g_iNumFailures++;
+                continue;
+            }
+            Score::FlagBowChanges(data.bowChange, bowChanges, data.pitches.size());
+            checkRoundTrip(data, path.filename().string());
+        }
+    }
+
+    ScoreData makeScore(size_t iNumFrames) {
+        ScoreData data;
+        data.hopSize = 0.01f;
+        for (size_t i = 0; i < iNumFrames; i++) {
+            data.pitches.push_back((i % 17 == 0) ? -1.f : (float)(i % 12) + 0.25f);
+            data.amplitude.push_back((float)(i % 10) / 10);
+            data.timeStamps.push_back((float)i * 0.011f);
+            data.bowChange.push_back(i % 7 == 0);
+        }
+        return data;
+    }
+
+    void testDamagedFiles() {
+        auto data = makeScore(100);
+        checkRoundTrip(data, "with time stamps");
+        data.timeStamps.clear();
+        checkRoundTrip(data, "without time stamps");
+        checkRoundTrip(makeScore(1), "single frame");
+
+        auto filePath = tempPath("valid");
+        BinaryScore::Write(filePath, makeScore(100).get());
+        auto bytes = readFile(filePath);
+
+        for (size_t iLength = 0; iLength < bytes.size(); iLength++)
+            checkRefused(bytes.substr(0, iLength), "truncated to " + std::to_string(iLength) + " bytes");
+
+        checkRefused(withField(bytes, 0, 'X'), "bad magic");
+        checkRefused(withField(bytes, kVersionOffset, BinaryScore::kVersion + 1), "newer version");
+        checkRefused(withField(bytes, kVersionOffset, uint32_t(0)), "version 0");
+        checkRefused(withField(bytes, kNumFramesOffset, uint64_t(0)), "zero frames");
+        checkRefused(withField(bytes, kNumFramesOffset, uint64_t(101)), "one frame more than written");
+        checkRefused(withField(bytes, kNumFramesOffset, uint64_t(1) << 40), "huge frame count");
+        checkRefused(withField(bytes, kNumFramesOffset, ~uint64_t(0)), "largest frame count");
+        for (float fHopSize : {0.f, -0.01f, 1e-7f, 1e30f, NAN})
+            checkRefused(withField(bytes, kHopSizeOffset, fHopSize), "hop size " + std::to_string(fHopSize));
+
+        BinaryScore binaryScore;
+        if (binaryScore.Open(tempPath("missing")) != kFileOpenError) {
+            std::printf("FAIL missing file: not kFileOpenError\n");
+            g_iNumFailures++;
+        }
+    }
+
+    void testWriteRefused() {
+        auto checkWrite = [](const ScoreData& data, const std::string& label) {
+            if (BinaryScore::Write(tempPath("refused"), data.get()) != kFunctionInvalidArgsError) {
+                std::printf("FAIL Write of %s: not kFunctionInvalidArgsError\n", label.c_str());
+                g_iNumFailures++;
+            }
+        };
+
+        checkWrite(ScoreData(), "an empty score");
+        auto data = makeScore(10);
+        data.amplitude.pop_back();
+        checkWrite(data, "a short amplitude column");
+        data = makeScore(10);
+        data.bowChange.push_back(0);
+        checkWrite(data, "a long bow change column");
+        data = makeScore(10);
+        data.timeStamps.pop_back();
+        checkWrite(data, "a short time stamp column");
+        data = makeScore(10);
+        data.timeStamps[5] = 0;
+        checkWrite(data, "decreasing time stamps");
+        data = makeScore(10);
+        data.hopSize = 1e-7f;
+        checkWrite(data, "a hop size below MIN_HOP_SIZE");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <Examples directory>\n", argv[0]);
+        return 1;
+    }
+
+    testExamples(argv[1]);
+    testDamagedFiles();
+    testWriteRefused();
+
+    for (auto name : {"roundtrip", "damaged", "valid", "refused"})
+        std::filesystem::remove(tempPath(name));
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// TrajectoryCompiler::ComputeFrameTargets against the per frame computation the perform loop did before
+// (walk the segments, Evaluate / GetTarget, then fret2Position and the profile velocity), for every
+// Examples/*.json at several transpositions, with the hop size and with irregular time stamps. Every
+// field of every frame has to be bit identical.
+//
+//   TrajectoryCompilerTest <Examples directory>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PitchFileParser.h"
+#include "TrajectoryCompiler.h"
+
+namespace {
+    int g_iNumFailures = 0;
+
+    /* The setpoint computation of the perform loop before the frames were precomputed */
+    FrameTarget computeFrame(const std::vector<MotionSegment>& segments, size_t& iSegment, size_t i, int8_t transpose,
+                             float hopSize, const std::vector<float>& timeStamps) {
+        while (segments[iSegment].iEndFrame <= i)
+            ++iSegment;
+        const auto& segment = segments[iSegment];
+        float fFrameDuration = hopSize;
+        if (i + 1 < timeStamps.size() && timeStamps[i + 1] > timeStamps[i])
+            fFrameDuration = timeStamps[i + 1] - timeStamps[i];
+
+        FrameTarget frame;
+        frame.fFretPosition = TrajectoryCompiler::Evaluate(segment, (double)i) + transpose;
+        frame.fSlideTarget = TrajectoryCompiler::GetTarget(segment, i, frame.fSlideSpeed) + transpose;
+        frame.fSlideSpeed /= fFrameDuration;
+
+        frame.lSlideTarget = Util::fret2Position(frame.fSlideTarget);
+        frame.ulSlideVelocity = SLIDE_PROFILE_VELOCITY;
+        if (frame.fSlideSpeed > 0)
+            frame.ulSlideVelocity = std::clamp((unsigned long)std::lround(Util::FretSpeedToRpm(frame.fSlideTarget, frame.fSlideSpeed)), 1ul, SLIDE_PROFILE_VELOCITY);
+        return frame;
+    }
+
+    bool isIdentical(const FrameTarget& a, const FrameTarget& b) {
+        auto isSame = [](float x, float y) { return std::memcmp(&x, &y, sizeof(float)) == 0; };
+        return isSame(a.fFretPosition, b.fFretPosition) && isSame(a.fSlideTarget, b.fSlideTarget) &&
+               isSame(a.fSlideSpeed, b.fSlideSpeed) && a.lSlideTarget == b.lSlideTarget && a.ulSlideVelocity == b.ulSlideVelocity;
+    }
+
+    void checkFrames(const std::vector<float>& pitches, float hopSize, const std::vector<float>& timeStamps, const std::string& label) {
+        std::vector<MotionSegment> segments;
+        auto err = TrajectoryCompiler::Compile(segments, pitches, hopSize);
+        if (err != kNoError || segments.empty() || segments.back().iEndFrame != pitches.size()) {
+            std::printf("FAIL %s: Compile error %d, %zu segments\n", label.c_str(), err, segments.size());
+            g_iNumFailures++;
+            return;
+        }
+
+        for (int8_t transpose : {0, 3, -5}) {
+            std::vector<FrameTarget> frames;
+            if ((err = TrajectoryCompiler::ComputeFrameTargets(frames, segments, transpose, hopSize, timeStamps)) != kNoError ||
+                frames.size() != pitches.size()) {
+                std::printf("FAIL %s transposed by %d: error %d, %zu frames\n", label.c_str(), transpose, err, frames.size());
+                g_iNumFailures++;
+                continue;
+            }
+
+            size_t iSegment = 0;
+            for (size_t i = 0; i < frames.size(); i++) {
+                auto expected = computeFrame(segments, iSegment, i, transpose, hopSize, timeStamps);
+                if (!isIdentical(frames[i], expected)) {
+                    std::printf("FAIL %s transposed by %d, frame %zu: %.9g %.9g %.9g %ld %lu, expected %.9g %.9g %.9g %ld %lu\n",
+                                label.c_str(), transpose, i, frames[i].fFretPosition, frames[i].fSlideTarget, frames[i].fSlideSpeed,
+                                frames[i].lSlideTarget, frames[i].ulSlideVelocity, expected.fFretPosition, expected.fSlideTarget,
+                                expected.fSlideSpeed, expected.lSlideTarget, expected.ulSlideVelocity);
+                    g_iNumFailures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    void testExamples(const std::string& examplesDir, std::mt19937& rng) {
+        std::vector<std::filesystem::path> files;
+        for (auto& entry : std::filesystem::directory_iterator(examplesDir)) {
+            if (entry.path().extension() == ".json")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::printf("FAIL no scores in %s\n", examplesDir.c_str());
+            g_iNumFailures++;
+        }
+
+        for (auto& path : files) {
+            std::vector<float> pitches, amplitude, timeStamps;
+            std::vector<size_t> bowChanges;
+            float hopSize;
+            PitchFileParser parser(path.string());
+            auto err = parser.parseJson(pitches, bowChanges, amplitude, hopSize, timeStamps);
+            if (err != kNoError) {
+                std::printf("FAIL %s: parse error %d\n", path.filename().c_str(), err);
+                g_iNumFailures++;
+                continue;
+            }
+            checkFrames(pitches, hopSize, timeStamps, path.filename().string());
+
+            // jittered time stamps, with some repeated ones that fall back to the hop size
+            std::uniform_real_distribution<float> jitter(0.5f, 1.5f);
+            timeStamps.assign(pitches.size(), 0);
+            for (size_t i = 1; i < timeStamps.size(); i++)
+                timeStamps[i] = timeStamps[i - 1] + ((i % 50 == 0) ? 0 : hopSize * jitter(rng));
+            checkFrames(pitches, hopSize, timeStamps, path.filename().string() + " with time stamps");
+        }
+    }
+
+    void testInvalidArgs() {
+        std::vector<MotionSegment> segments;
+        std::vector<float> pitches(100, 3.f);
+        TrajectoryCompiler::Compile(segments, pitches, 0.01f);
+
+        std::vector<FrameTarget> frames;
+        if (TrajectoryCompiler::ComputeFrameTargets(frames, {}, 0, 0.01f) != kFunctionInvalidArgsError ||
+            TrajectoryCompiler::ComputeFrameTargets(frames, segments, 0, 0) != kFunctionInvalidArgsError ||
+            TrajectoryCompiler::ComputeFrameTargets(frames, segments, 0, 0.01f, std::vector<float>(99, 0.f)) != kFunctionInvalidArgsError) {
+            std::printf("FAIL ComputeFrameTargets accepted no segments, a zero hop size or a short time stamp column\n");
+            g_iNumFailures++;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <Examples directory>\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1);
+    testExamples(argv[1], rng);
+    testInvalidArgs();
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
@@ -25,6 +25,7 @@ enum Error_t
     kNaNError,
 
     kMemError,
+    kTimeoutError,
 
     kUnknownError,
 
@@ -33,9 +33,31 @@ static const int MAX_ENCODER_INC            = 20000;
 static const int NUT_POSITION               = 3000;
 static const float P2P_MULTIPLIER           = 10300.f/100.f;    // Pulses per mm
 static const unsigned int MAX_FOLLOW_ERROR  = 20000;
+static const int ENCODER_INC_PER_TURN       = 2048; // quad counts per motor revolution (4 x encoder CPT), checked against the drive before IPM
+static const int IPM_MAX_SEGMENT_MS         = 255;  // longest PVT segment the EPOS accepts
+static const unsigned long SLIDE_PROFILE_VELOCITY       = 4000;     // rpm
+static const unsigned long SLIDE_PROFILE_ACCELERATION   = 30000;    // rpm/s
 
 static const float PITCH_CORRECTION_FACTOR  = 0; //0.001;
 
+// Performance timing
+static const int PITCH_HOP_SIZE_US          = 5500; // number depends on hopsize of pitch track
+static const float MIN_HOP_SIZE             = 1e-3f; // seconds, shortest frame period a score may ask for
+static const float MAX_HOP_SIZE             = 10.f;  // seconds
+static const int SCHEDULER_SPIN_US          = 200;  // busy wait this long before each frame deadline
+static const int TRACKING_RATE_HZ           = 1000; // finger position control rate
+
+// Trajectory compiler
+static const float TRAJECTORY_TOLERANCE         = 0.1f;     // semitones a hold or ramp may deviate from the pitch track
+static const float OSCILLATION_TOLERANCE_FACTOR = 3.f;      // oscillations may deviate this many times as much
+static const float OSCILLATION_MIN_DEPTH        = 0.3f;     // semitones peak to trough
+static const float OSCILLATION_MIN_RATE         = 2.f;      // Hz
+static const float OSCILLATION_MAX_RATE         = 12.f;     // Hz
+static const int OSCILLATION_MIN_EXTREMA        = 4;        // peaks and troughs needed to call it an oscillation
+
+// Preprocessed scores, relative to the working directory
+#define SCORE_CACHE_DIR ".score_cache"
+
 // Finger
 #define FINGER_OFF 40
 #define FINGER_ON 18
@@ -47,6 +69,8 @@ static const float PITCH_CORRECTION_FACTOR  = 0; //0.001;
 #define FINGER_OFF_MIN 105
 #define FINGER_ON_MIN 85
 
+#define FINGER_WAIT_TIMEOUT_MS 1000
+
 // Bow
 #define BOW_PITCH_TRANSLATION 127
 #define MIN_PITCH 196    // 202.15
@@ -0,0 +1,95 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_SETPOINT_H
+#define HATHAANI_SETPOINT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "MyDefinitions.h"
+
+/* Everything the perform thread commands for one frame */
+struct Setpoint {
+    float fFretPosition = 0;                            // where the pitch should be in this frame
+    float fSlideTarget = 0;                             // fret position the slide is moving towards
+    float fSlideSpeed = 0;                              // frets per second for that move, 0 for the default profile
+    long lSlideTarget = NUT_POSITION;                   // fSlideTarget in encoder pulses
+    unsigned long ulSlideVelocity = SLIDE_PROFILE_VELOCITY; // profile velocity (rpm) for that move
+    bool bFingerOn = false;
+    float fBowAmplitude = 0;
+    Bow::Direction bowDirection = Bow::Down;
+
+    std::chrono::steady_clock::time_point timeStamp;    // when the setpoint was published
+    uint32_t uiSequence = 0;                            // number of publishes before this one
+};
+
+/* Single writer / multiple reader channel for the current Setpoint (seqlock).
+ * publish() must only be called from one thread. read() can be called from any thread,
+ * never blocks the writer and always returns a snapshot from a single publish. */
+class SetpointChannel {
+public:
+    void publish(const Setpoint& setpoint) {
+        auto seq = m_uiSequence.load(std::memory_order_relaxed);
+        m_uiSequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        m_fFretPosition.store(setpoint.fFretPosition, std::memory_order_relaxed);
+        m_fSlideTarget.store(setpoint.fSlideTarget, std::memory_order_relaxed);
+        m_fSlideSpeed.store(setpoint.fSlideSpeed, std::memory_order_relaxed);
+        m_lSlideTarget.store(setpoint.lSlideTarget, std::memory_order_relaxed);
+        m_ulSlideVelocity.store(setpoint.ulSlideVelocity, std::memory_order_relaxed);
+        m_bFingerOn.store(setpoint.bFingerOn, std::memory_order_relaxed);
+        m_fBowAmplitude.store(setpoint.fBowAmplitude, std::memory_order_relaxed);
+        m_bowDirection.store(setpoint.bowDirection, std::memory_order_relaxed);
+        m_iTimeStamp.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+        m_uiSequence.store(seq + 2, std::memory_order_release);
+    }
+
+    [[nodiscard]] Setpoint read() const {
+        Setpoint setpoint;
+        uint32_t seq0, seq1;
+        do {
+            seq0 = m_uiSequence.load(std::memory_order_acquire);
+
+            setpoint.fFretPosition = m_fFretPosition.load(std::memory_order_relaxed);
+            setpoint.fSlideTarget = m_fSlideTarget.load(std::memory_order_relaxed);
+            setpoint.fSlideSpeed = m_fSlideSpeed.load(std::memory_order_relaxed);
+            setpoint.lSlideTarget = m_lSlideTarget.load(std::memory_order_relaxed);
+            setpoint.ulSlideVelocity = m_ulSlideVelocity.load(std::memory_order_relaxed);
+            setpoint.bFingerOn = m_bFingerOn.load(std::memory_order_relaxed);
+            setpoint.fBowAmplitude = m_fBowAmplitude.load(std::memory_order_relaxed);
+            setpoint.bowDirection = m_bowDirection.load(std::memory_order_relaxed);
+            auto iTimeStamp = m_iTimeStamp.load(std::memory_order_relaxed);
+            setpoint.timeStamp = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(iTimeStamp));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq1 = m_uiSequence.load(std::memory_order_relaxed);
+        } while ((seq0 & 1) || seq0 != seq1);
+
+        setpoint.uiSequence = seq0 >> 1;
+        return setpoint;
+    }
+
+    [[nodiscard]] float getFretPosition() const {
+        return read().fFretPosition;
+    }
+
+private:
+    std::atomic<uint32_t> m_uiSequence {0};
+
+    std::atomic<float> m_fFretPosition {0};
+    std::atomic<float> m_fSlideTarget {0};
+    std::atomic<float> m_fSlideSpeed {0};
+    std::atomic<long> m_lSlideTarget {NUT_POSITION};
+    std::atomic<unsigned long> m_ulSlideVelocity {SLIDE_PROFILE_VELOCITY};
+    std::atomic<bool> m_bFingerOn {false};
+    std::atomic<float> m_fBowAmplitude {0};
+    std::atomic<Bow::Direction> m_bowDirection {Bow::Down};
+    std::atomic<std::chrono::steady_clock::rep> m_iTimeStamp {0};
+};
+
+#endif //HATHAANI_SETPOINT_H
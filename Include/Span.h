@@ -0,0 +1,35 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_SPAN_H
+#define HATHAANI_SPAN_H
+
+#include <cstddef>
+#include <vector>
+
+/* Read-only view of a contiguous array owned by someone else (std::span is C++20).
+ * Converts implicitly from a vector, so functions taking a Span still accept vectors. */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(const T* pData, size_t iLength) : m_pData(pData), m_iLength(iLength) {}
+    Span(const std::vector<T>& vector) : m_pData(vector.data()), m_iLength(vector.size()) {}    // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] const T* data() const { return m_pData; }
+    [[nodiscard]] size_t size() const { return m_iLength; }
+    [[nodiscard]] bool empty() const { return m_iLength == 0; }
+
+    const T& operator[](size_t i) const { return m_pData[i]; }
+    [[nodiscard]] const T& back() const { return m_pData[m_iLength - 1]; }
+
+    [[nodiscard]] const T* begin() const { return m_pData; }
+    [[nodiscard]] const T* end() const { return m_pData + m_iLength; }
+
+private:
+    const T* m_pData = nullptr;
+    size_t m_iLength = 0;
+};
+
+#endif //HATHAANI_SPAN_H
@@ -0,0 +1,123 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_SPSCQUEUE_H
+#define HATHAANI_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "Util.h"
+
+/* Lock-free single producer / single consumer FIFO of T.
+ * push() must only be called from one thread and pop() only from one (other) thread.
+ * Blocks are pushed and popped as a whole, a push that does not fit is rejected. */
+template <typename T>
+class SpscQueue {
+public:
+    /* capacity is rounded up to the next power of 2 */
+    explicit SpscQueue(size_t capacity) : m_buffer(CUtil::nextPowOf2(static_cast<int>(capacity))),
+                                          m_iMask(m_buffer.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /* Appends iLength values. Returns false (and pushes nothing) if there is not enough room */
+    bool push(const T* pData, size_t iLength) {
+        auto iWrite = m_iWriteIdx.load(std::memory_order_relaxed);
+        auto iRead = m_iReadIdx.load(std::memory_order_acquire);
+        if (m_buffer.size() - (iWrite - iRead) < iLength)
+            return false;
+
+        for (size_t i = 0; i < iLength; ++i)
+            m_buffer[(iWrite + i) & m_iMask] = pData[i];
+
+        m_iWriteIdx.store(iWrite + iLength, std::memory_order_release);
+        return true;
+    }
+
+    /* Appends iLength values produced by value(i), for sources that need converting on the way in.
+     * Returns false (and pushes nothing) if there is not enough room */
+    template <typename Fn>
+    bool push(size_t iLength, Fn&& value) {
+        auto iWrite = m_iWriteIdx.load(std::memory_order_relaxed);
+        auto iRead = m_iReadIdx.load(std::memory_order_acquire);
+        if (m_buffer.size() - (iWrite - iRead) < iLength)
+            return false;
+
+        for (size_t i = 0; i < iLength; ++i)
+            m_buffer[(iWrite + i) & m_iMask] = value(i);
+
+        m_iWriteIdx.store(iWrite + iLength, std::memory_order_release);
+        return true;
+    }
+
+    /* Push in pieces: reserve() claims room for iLength values (false if there is none), write() fills
+     * position i of that room and publish() hands all of it to pop() at once. A reservation that is never
+     * published is simply dropped by the next reserve(). Producer thread only. */
+    bool reserve(size_t iLength) {
+        auto iWrite = m_iWriteIdx.load(std::memory_order_relaxed);
+        auto iRead = m_iReadIdx.load(std::memory_order_acquire);
+        if (m_buffer.size() - (iWrite - iRead) < iLength)
+            return false;
+
+        m_iReserved = iLength;
+        return true;
+    }
+
+    void write(size_t i, const T& value) {
+        m_buffer[(m_iWriteIdx.load(std::memory_order_relaxed) + i) & m_iMask] = value;
+    }
+
+    void publish() {
+        m_iWriteIdx.store(m_iWriteIdx.load(std::memory_order_relaxed) + m_iReserved, std::memory_order_release);
+        m_iReserved = 0;
+    }
+
+    /* Removes iLength values into pDest. Returns false (and pops nothing) if fewer are available */
+    bool pop(T* pDest, size_t iLength) {
+        auto iRead = m_iReadIdx.load(std::memory_order_relaxed);
+        auto iWrite = m_iWriteIdx.load(std::memory_order_acquire);
+        if (iWrite - iRead < iLength)
+            return false;
+
+        for (size_t i = 0; i < iLength; ++i)
+            pDest[i] = m_buffer[(iRead + i) & m_iMask];
+
+        m_iReadIdx.store(iRead + iLength, std::memory_order_release);
+        return true;
+    }
+
+    /* Number of values that can be popped. On the consumer thread this is a lower bound, the producer may add more */
+    [[nodiscard]] size_t size() const {
+        return m_iWriteIdx.load(std::memory_order_acquire) - m_iReadIdx.load(std::memory_order_acquire);
+    }
+
+    /* Number of values that can be pushed. On the producer thread this is a lower bound, the consumer may free more */
+    [[nodiscard]] size_t space() const {
+        return m_buffer.size() - size();
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return m_buffer.size();
+    }
+
+    /* Only safe while neither side is running */
+    void clear() {
+        m_iReadIdx.store(0, std::memory_order_relaxed);
+        m_iWriteIdx.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> m_buffer;
+    const size_t m_iMask;
+    size_t m_iReserved = 0;     // producer side only
+
+    // on separate cache lines so that the producer and consumer do not invalidate each other
+    alignas(64) std::atomic<size_t> m_iWriteIdx {0};
+    alignas(64) std::atomic<size_t> m_iReadIdx {0};
+};
+
+#endif //HATHAANI_SPSCQUEUE_H
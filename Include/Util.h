@@ -115,6 +115,8 @@ public:
                 return "kOutOfBoundsError";
             case kMemError:
                 return "kMemError";
+            case kTimeoutError:
+                return "kTimeoutError";
             default:
                 return "kUnknownError";
         }
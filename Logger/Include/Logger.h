@@ -23,7 +23,20 @@ public:
         n_levels
     };
 
-    static void init(Level level = trace);
+    enum Mode
+    {
+        sync,   // format and write on the calling thread
+        async   // queue the message, a background thread formats and writes it
+    };
+
+    static constexpr size_t kDefaultQueueSize = 8192;
+
+    /* In async mode messages go through a preallocated queue of queueSize entries. When the queue is
+     * full the oldest message is dropped, so logging never waits for the output. */
+    static void init(Level level = trace, Mode mode = sync, size_t queueSize = kDefaultQueueSize);
+
+    /* Writes out queued messages and stops the background thread */
+    static void shutdown();
 
     template<typename T>
     static void pprintArray(T* array, int size) {
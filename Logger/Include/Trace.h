@@ -0,0 +1,98 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_TRACE_H
+#define HATHAANI_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+/* Events below this level compile to nothing (same values as SPDLOG_ACTIVE_LEVEL) */
+#ifndef TRACE_ACTIVE_LEVEL
+#define TRACE_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#endif
+
+/* Binary trace for the real time paths. record() copies a few raw values into a preallocated ring
+ * (oldest entries are overwritten), so the caller does no formatting, no allocation and no syscall.
+ * Formatting happens in dump(), after the performance. */
+class Trace {
+public:
+    enum Event : uint16_t {
+        DxlGoalPosition,    // arg: servo id, value: goal position (pulses)
+        DxlSyncWrite,       // arg: servo id, value: register value sent by the bus thread
+        TunerNote,          // arg: -, value: detected note
+        AudioOverrun,       // arg: -, value: periods dropped so far because the tuner did not keep up
+        AudioXrun,          // arg: -, value: ALSA capture overruns so far
+
+        kNumEvents
+    };
+
+    struct Entry {
+        int64_t iTimeNs;    // steady clock
+        Event event;
+        int32_t iArg;
+        double fValue;
+    };
+
+    static constexpr size_t kDefaultCapacity = 1 << 16;
+
+    /* Allocates the ring, capacity is rounded up to a power of two. Not thread safe. */
+    static void init(size_t capacity = kDefaultCapacity);
+
+    /* Safe to call from any number of threads. No-op before init(). Two threads only share a slot
+     * when the ring wraps around within one call, the entry may be torn then. */
+    static void record(Event event, int32_t iArg, double fValue) {
+        auto* pEntries = s_pEntries.load(std::memory_order_acquire);
+        if (!pEntries)
+            return;
+
+        auto iIndex = s_iNumRecorded.fetch_add(1, std::memory_order_relaxed);
+        auto& entry = pEntries[iIndex & s_iMask];
+        entry.iTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        entry.event = event;
+        entry.iArg = iArg;
+        entry.fValue = fValue;
+    }
+
+    /* Writes the recorded entries (oldest first) to filePath as csv, or to the log if filePath is empty.
+     * Recording is paused meanwhile, an entry written in the very moment the dump starts may be torn. */
+    static void dump(const std::string& filePath = "");
+    static void clear();
+
+    static const char* getEventName(Event event);
+
+private:
+    static void dumpEntries(const std::string& filePath);
+
+    static std::vector<Entry> s_entries;
+    static std::atomic<Entry*> s_pEntries;
+    static size_t s_iMask;
+    static std::atomic<uint64_t> s_iNumRecorded;
+};
+
+#if TRACE_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define TRACE_VERBOSE(event, arg, value)    Trace::record(event, arg, value)
+#else
+#define TRACE_VERBOSE(event, arg, value)    (void)0
+#endif
+
+#if TRACE_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define TRACE_DEBUG(event, arg, value)      Trace::record(event, arg, value)
+#else
+#define TRACE_DEBUG(event, arg, value)      (void)0
+#endif
+
+#if TRACE_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define TRACE_INFO(event, arg, value)       Trace::record(event, arg, value)
+#else
+#define TRACE_INFO(event, arg, value)       (void)0
+#endif
+
+#endif //HATHAANI_TRACE_H
@@ -6,6 +6,7 @@
 #define HATHAANI_SPDLOG_PCH_H
 
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 #endif //HATHAANI_SPDLOG_PCH_H
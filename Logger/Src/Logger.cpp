@@ -4,8 +4,19 @@
 
 #include "Logger.h"
 
-void Logger::init(Level level) {
+void Logger::init(Level level, Mode mode, size_t queueSize) {
+    if (mode == async) {
+        spdlog::init_thread_pool(queueSize, 1);
+        auto logger = spdlog::create_async_nb<spdlog::sinks::stdout_color_sink_mt>("async_logger");
+        spdlog::set_default_logger(logger);
+        spdlog::flush_every(std::chrono::seconds(1));
+    }
+
     spdlog::set_pattern("%^[%r]\t[%s]\t[line %#]\t[---%l---]\t%v%$");
     spdlog::set_level((spdlog::level::level_enum)level);
-    LOG_INFO("Logger initialized");
+    LOG_INFO("Logger initialized ({})", (mode == async) ? "async" : "sync");
+}
+
+void Logger::shutdown() {
+    spdlog::shutdown();
 }
@@ -0,0 +1,83 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include "Trace.h"
+
+std::vector<Trace::Entry> Trace::s_entries;
+std::atomic<Trace::Entry*> Trace::s_pEntries = nullptr;
+size_t Trace::s_iMask = 0;
+std::atomic<uint64_t> Trace::s_iNumRecorded = 0;
+
+void Trace::init(size_t capacity) {
+    size_t iSize = 1;
+    while (iSize < capacity)
+        iSize <<= 1;
+
+    s_pEntries = nullptr;
+    s_entries.assign(iSize, Entry());
+    s_iMask = iSize - 1;
+    s_iNumRecorded = 0;
+    s_pEntries.store(s_entries.data(), std::memory_order_release);
+}
+
+void Trace::clear() {
+    s_iNumRecorded = 0;
+}
+
+const char* Trace::getEventName(Event event) {
+    switch (event) {
+        case DxlGoalPosition:
+            return "DxlGoalPosition";
+        case DxlSyncWrite:
+            return "DxlSyncWrite";
+        case TunerNote:
+            return "TunerNote";
+        case AudioOverrun:
+            return "AudioOverrun";
+        case AudioXrun:
+            return "AudioXrun";
+        default:
+            return "Unknown";
+    }
+}
+
+void Trace::dump(const std::string& filePath) {
+    auto* pEntries = s_pEntries.exchange(nullptr);
+    if (!pEntries)
+        return;
+
+    dumpEntries(filePath);
+    s_pEntries.store(pEntries, std::memory_order_release);
+}
+
+void Trace::dumpEntries(const std::string& filePath) {
+    uint64_t iNumRecorded = s_iNumRecorded.load(std::memory_order_acquire);
+    if (iNumRecorded == 0)
+        return;
+
+    uint64_t iNumEntries = std::min<uint64_t>(iNumRecorded, s_entries.size());
+    if (iNumEntries < iNumRecorded)
+        LOG_WARN("Trace overflowed, only the last {} of {} entries were kept", iNumEntries, iNumRecorded);
+
+    std::ofstream file;
+    if (!filePath.empty()) {
+        file.open(filePath);
+        if (!file.is_open()) {
+            LOG_ERROR("Cannot open trace file {}", filePath);
+            return;
+        }
+        file << "time_ns,event,arg,value\n";
+    }
+
+    for (uint64_t i = iNumRecorded - iNumEntries; i < iNumRecorded; ++i) {
+        const auto& entry = s_entries[i & s_iMask];
+        if (file.is_open())
+            file << entry.iTimeNs << ',' << getEventName(entry.event) << ',' << entry.iArg << ',' << entry.fValue << '\n';
+        else
+            LOG_INFO("{} {} {} {}", entry.iTimeNs, getEventName(entry.event), entry.iArg, entry.fValue);
+    }
+
+    if (file.is_open())
+        LOG_INFO("Wrote {} trace entries to {}", iNumEntries, filePath);
+}
@@ -3,6 +3,121 @@
 
 #include "ErrorDef.h"
 #include <cmath>
+#include <string>
+
+namespace LaszloFft { struct Plan; }
+
+/*! \brief in-place complex FFT of a fixed power of 2 length (at least 4), values interleaved re, im.
+    Twiddles and the bit reversal permutation are computed once in init; the input of process has to be
+    in bit reversed order already, so that callers can permute while copying their data in (\sa getBitReverse)
+*/
+class CComplexFft
+{
+public:
+    CComplexFft () = default;
+    ~CComplexFft ();
+    CComplexFft (const CComplexFft&) = delete;
+    CComplexFft& operator= (const CComplexFft&) = delete;
+
+    Error_t init (int iLength);
+    void reset ();
+
+    /*! forward transform (exp(-i...)), unscaled
+    \param float * pfData: 2 * iLength floats, input in bit reversed order, output in natural order
+    */
+    void process (float *pfData) const;
+
+    /*! bit reversed index of every element */
+    [[nodiscard]] const int* getBitReverse () const { return m_piBitReverse; }
+    [[nodiscard]] int getLength () const { return m_iLength; }
+
+private:
+    int     m_iLength       = 0;
+    float   *m_pfTwiddle    = nullptr;      // twiddles of every stage from length 8 on, one stage after the other
+    int     *m_piBitReverse = nullptr;
+};
+
+/*! \brief real FFT implementation behind CFft. All backends use the same in-place split format
+    re(0),re(1),...,re(N/2),im(N/2-1),...,im(1) with the forward transform scaled by 1/N and the inverse unscaled.
+*/
+class CFftBackend
+{
+public:
+    enum Type
+    {
+        kSplitRadix,            //!< Sorensen's real split radix FFT (LaszloFft)
+        kPackedComplex,         //!< N/2 point complex FFT of the even/odd sample pairs with precomputed tables
+
+        kNumBackends
+    };
+
+    /*! creates a new backend
+    \param CFftBackend * & pCInstance: pointer to the new instance
+    \param Type eType: implementation
+    \return Error_t
+    */
+    static Error_t createInstance (CFftBackend*& pCInstance, Type eType);
+
+    /*! destroys a backend
+    \param CFftBackend * & pCInstance: pointer to the instance to be destroyed
+    \return Error_t
+    */
+    static Error_t destroyInstance (CFftBackend*& pCInstance);
+
+    /*! prepares the backend for one FFT length
+    \param int iFftLength: power of 2
+    \return Error_t
+    */
+    virtual Error_t initInstance (int iFftLength) = 0;
+    virtual Error_t resetInstance () = 0;
+
+    /*! real input of length iFftLength to split format spectrum, in place */
+    virtual void forward (float *pfData) = 0;
+    /*! split format spectrum to real output, in place */
+    virtual void inverse (float *pfData) = 0;
+
+    virtual ~CFftBackend () = default;
+
+protected:
+    CFftBackend () = default;
+};
+
+/*! LaszloFft::realfft_split / irealfft_split with their trig values and bit reversal swaps planned once in initInstance */
+class CSplitRadixFftBackend : public CFftBackend
+{
+public:
+    CSplitRadixFftBackend () = default;
+    ~CSplitRadixFftBackend () override;
+
+    Error_t initInstance (int iFftLength) override;
+    Error_t resetInstance () override;
+    void forward (float *pfData) override;
+    void inverse (float *pfData) override;
+
+private:
+    LaszloFft::Plan *m_pPlan = nullptr;
+};
+
+/*! Packs the even and odd samples into one complex signal of half the length, transforms that with
+    CComplexFft and separates the two spectra again with a precomputed twiddle table (needs iFftLength >= 8) */
+class CPackedComplexFftBackend : public CFftBackend
+{
+public:
+    CPackedComplexFftBackend () = default;
+    ~CPackedComplexFftBackend () override;
+
+    Error_t initInstance (int iFftLength) override;
+    Error_t resetInstance () override;
+    void forward (float *pfData) override;
+    void inverse (float *pfData) override;
+
+private:
+    CComplexFft m_CComplexFft;
+
+    int     m_iFftLength    = 0;
+    float   *m_pfTwiddle    = nullptr;      // exp(-2 pi i k / iFftLength) for k = 0 .. iFftLength / 4
+    float   *m_pfScratch    = nullptr;      // iFftLength floats, the packed complex signal
+};
 
 class CFft
 {
@@ -44,9 +159,10 @@ public:
     \param int iZeroPadFactor: fft length (zeropadded)
     \param WindowFunction_t eWindow: window type
     \param Windowing_t eWindowing: apply window before FFT, after IFFT, or both
+    \param CFftBackend::Type eBackend: real FFT implementation (blocks zero padded by 4 or more use the pruned FFT instead)
     \return Error_t
     */
-    Error_t initInstance (int iBlockLength, int iZeroPadFactor = 1, WindowFunction_t eWindow = kWindowHann, Windowing_t eWindowing = kPreWindow);
+    Error_t initInstance (int iBlockLength, int iZeroPadFactor = 1, WindowFunction_t eWindow = kWindowHann, Windowing_t eWindowing = kPreWindow, CFftBackend::Type eBackend = CFftBackend::kSplitRadix);
     
     /*! resets an FFT instance
     \return Error_t
@@ -70,6 +186,14 @@ public:
     \return Error_t
     */
     [[maybe_unused]] Error_t doFft (complex_t *pfSpectrum, const float *pfInput);
+    /*! perform the FFT on the most recent block of a circular buffer, the window is applied while copying
+    \param complex_t * pfSpectrum: output result of length iBlockLength * iZeroPadFactor (\sa initInstance)
+    \param const float * pfRing: circular input buffer
+    \param int iRingLength: length of pfRing, power of 2 and at least iBlockLength
+    \param int iStartIdx: ring index of the first sample of the block (wrapped into the ring)
+    \return Error_t
+    */
+    Error_t doFft (complex_t *pfSpectrum, const float *pfRing, int iRingLength, int iStartIdx);
     /*! perform IFFT
     \param float * pfOutput: time domain output signal of length iBlockLength * iZeroPadFactor (\sa initInstance)
     \param const complex_t * pfSpectrum: input spectrum of length iBlockLength * iZeroPadFactor (\sa initInstance)
@@ -144,12 +268,25 @@ private:
     Error_t allocMemory ();
     Error_t freeMemory ();
     Error_t computeWindow (WindowFunction_t eWindow);
+    Error_t computePruningTables ();
+
+    Error_t computeFft (complex_t *pfSpectrum);
+    void computePrunedFft (complex_t *pfSpectrum);
 
     float   *m_pfProcessBuff;
     float   *m_pfWindowBuff;
 
+    CFftBackend *m_pCBackend        = nullptr;
+    CFftBackend::Type m_eBackend    = CFftBackend::kSplitRadix;
+
+    // only used for zero padded blocks (\sa computePrunedFft)
+    float   *m_pfModulation     = nullptr;
+    CComplexFft m_CPrunedFft;
+
     int     m_iDataLength;
     int     m_iFftLength;
+    int     m_iZeroPadFactor;
+    bool    m_bPruned;
 
     Windowing_t m_ePrePostWindowOpt;
 
@@ -0,0 +1,131 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_PITCHESTIMATOR_H
+#define HATHAANI_PITCHESTIMATOR_H
+
+#include <string>
+
+#include "ErrorDef.h"
+#include "Fft.h"
+
+/* Estimates the fundamental frequency of the most recent block of samples in a circular buffer */
+class CPitchEstimator {
+public:
+    inline static const std::string kName = "CPitchEstimator";
+
+    enum Type {
+        kFftPeak,       //!< peak of the zero padded magnitude spectrum
+        kYin,           //!< YIN (de Cheveigné & Kawahara 2002) on the raw samples
+
+        kNumTypes
+    };
+
+    static constexpr float kDefaultMinFreq = 150.f;     // a bit below the violin's open G
+    static constexpr float kDefaultMaxFreq = 500.f;
+
+    /*! creates a new estimator
+    \param CPitchEstimator * & pCInstance: pointer to the new instance
+    \param Type eType: algorithm
+    \return Error_t
+    */
+    static Error_t createInstance(CPitchEstimator*& pCInstance, Type eType);
+
+    /*! destroys an estimator
+    \param CPitchEstimator * & pCInstance: pointer to the instance to be destroyed
+    \return Error_t
+    */
+    static Error_t destroyInstance(CPitchEstimator*& pCInstance);
+
+    /*! initializes the estimator
+    \param int iBlockLength: number of samples analysed per call, power of 2
+    \param float fSampleRate: sample rate in Hz
+    \param float fMinFreq: lowest fundamental to look for
+    \param float fMaxFreq: highest fundamental to look for
+    \return Error_t
+    */
+    virtual Error_t initInstance(int iBlockLength, float fSampleRate, float fMinFreq = kDefaultMinFreq, float fMaxFreq = kDefaultMaxFreq) = 0;
+
+    /*! frees everything allocated in initInstance
+    \return Error_t
+    */
+    virtual Error_t resetInstance() = 0;
+
+    /*! estimates the fundamental frequency
+    \param float & fF0: frequency in Hz, 0 if no periodicity was found
+    \param const float * pfRing: circular input buffer
+    \param int iRingLength: length of pfRing, power of 2 and at least iBlockLength
+    \param int iStartIdx: ring index of the first sample of the block
+    \return Error_t
+    */
+    virtual Error_t process(float& fF0, const float* pfRing, int iRingLength, int iStartIdx) = 0;
+
+    virtual ~CPitchEstimator() = default;
+
+protected:
+    CPitchEstimator() = default;
+};
+
+/* The tuner's original estimator: argmax of the zero padded magnitude spectrum, refined with a
+ * parabola through the log magnitudes. Picks the strongest partial, which is not always the fundamental.
+ * Only the bins between fMinFreq and fMaxFreq are searched. */
+class CFftPitchEstimator : public CPitchEstimator {
+public:
+    static const int kZeroPaddingFactor = 16;
+
+    CFftPitchEstimator() = default;
+    ~CFftPitchEstimator() override;
+
+    Error_t initInstance(int iBlockLength, float fSampleRate, float fMinFreq = kDefaultMinFreq, float fMaxFreq = kDefaultMaxFreq) override;
+    Error_t resetInstance() override;
+    Error_t process(float& fF0, const float* pfRing, int iRingLength, int iStartIdx) override;
+
+private:
+    CFft* m_pCFft = nullptr;
+    CFft::complex_t* m_pfSpectrum = nullptr;
+    float* m_pfMag = nullptr;
+
+    float m_fSampleRate = 0;
+    int m_iMinBin = 0;
+    int m_iMaxBin = 0;
+};
+
+/* YIN: cumulative mean normalized difference function on the raw block. The first dip below
+ * kThreshold is the period, so a weak fundamental under strong harmonics is still found.
+ * At the tuner's 2 kHz the period is only 4-13 samples, so the difference function is evaluated in
+ * 1/kLagOversampling sample steps: the autocorrelation is computed at integer lags and sinc
+ * interpolated in between, which is exact for a band limited signal up to the interpolator's length. */
+class CYinPitchEstimator : public CPitchEstimator {
+public:
+    static constexpr float kThreshold = .15f;           // absolute threshold on the normalized difference
+    static constexpr float kUnvoicedThreshold = .5f;    // no dip below this means no pitch
+    static const int kLagOversampling = 4;              // lag steps per sample
+    static const int kInterpolatorHalfLength = 16;      // integer lags on each side of an interpolated one
+
+    CYinPitchEstimator() = default;
+    ~CYinPitchEstimator() override;
+
+    Error_t initInstance(int iBlockLength, float fSampleRate, float fMinFreq = kDefaultMinFreq, float fMaxFreq = kDefaultMaxFreq) override;
+    Error_t resetInstance() override;
+    Error_t process(float& fF0, const float* pfRing, int iRingLength, int iStartIdx) override;
+
+private:
+    void computeDifference();
+    [[nodiscard]] float interpolateMinimum(int iTau) const;
+
+    float* m_pfBlock = nullptr;         // the block, unwrapped
+    float* m_pfAcf = nullptr;           // autocorrelation at integer lags
+    float* m_pfEnergy = nullptr;        // energy of the lagged window at integer lags
+    float* m_pfInterpolator = nullptr;  // windowed sinc taps for each fractional phase
+    float* m_pfDiff = nullptr;          // normalized difference, in 1 / kLagOversampling sample steps
+
+    int m_iBlockLength = 0;
+    int m_iWindowLength = 0;
+    int m_iMinLag = 0;                  // in fractional lag steps
+    int m_iMaxLag = 0;
+    int m_iMaxIntLag = 0;               // in samples
+    float m_fSampleRate = 0;
+};
+
+#endif //HATHAANI_PITCHESTIMATOR_H
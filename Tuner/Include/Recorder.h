@@ -7,16 +7,38 @@
 
 #include <cstdint>
 #include "ErrorDef.h"
+#include "SpscQueue.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <iostream>
 #include <fstream>
 #include <cstdio>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <alsa/asoundlib.h>
 
+/* Captures from an ALSA device on its own thread. Each period is converted to float and pushed
+ * into a lock-free queue, Record() pops the next period on the consumer's thread. A slow consumer
+ * therefore only fills the queue (overruns, the newest period is dropped) and never stalls the device.
+ * In kMmap mode the samples are converted straight out of the device's DMA area into the queue,
+ * without the intermediate int16 copy and the read syscall (the int16 copy is only made for the file
+ * when saving). */
 class CRecorder {
 public:
     inline static const std::string kName = "CRecorder";
+    static const int kQueueLengthInPeriods = 16;
+    static const int kRecordTimeoutInPeriods = 8;
+
+    enum AccessMode {
+        kReadWrite,     //!< snd_pcm_readi into an int16 buffer
+        kMmap           //!< snd_pcm_mmap_begin / commit, falls back to kReadWrite if the device can not do it
+    };
     static void Create (CRecorder*& pCInstance)
     {
         pCInstance = new CRecorder();
@@ -27,9 +49,10 @@ public:
         delete pCInstance;
     }
 
-    Error_t Init(const std::string& sDevice, float* buffer, unsigned int sampleRate = 44100, int bufferFrames = 128, int numChannel = 1, int bitDepth = 16, bool saveToFile = false)
+    Error_t Init(const std::string& sDevice, float* buffer, unsigned int sampleRate = 44100, int bufferFrames = 128, int numChannel = 1, int bitDepth = 16, bool saveToFile = false, AccessMode accessMode = kReadWrite)
     {
         m_sDeviceName = sDevice;
+        m_accessMode = accessMode;
         m_pfBuffer = buffer;
         m_uiSampleRate = sampleRate;
         m_iBufferFrames = bufferFrames;
@@ -57,7 +80,14 @@ public:
         }
         fprintf(stdout, "hw_params initialized\n");
 
-        if ((err = snd_pcm_hw_params_set_access (m_captureHandle, m_hwParams, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
+        if (m_accessMode == kMmap) {
+            if ((err = snd_pcm_hw_params_set_access (m_captureHandle, m_hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED)) < 0) {
+                fprintf (stderr, "mmap access not supported (%s), using read/write access\n", snd_strerror (err));
+                m_accessMode = kReadWrite;
+            }
+        }
+
+        if (m_accessMode == kReadWrite && (err = snd_pcm_hw_params_set_access (m_captureHandle, m_hwParams, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
             fprintf (stderr, "cannot set access type (%s)\n", snd_strerror (err));
             return kFileAccessError;
         }
@@ -81,6 +111,16 @@ public:
         }
         fprintf(stdout, "hw_params channels set\n");
 
+        if (m_accessMode == kMmap) {
+            // wake up once per period, there is no blocking read to pace the capture thread
+            auto periodSize = (snd_pcm_uframes_t)m_iBufferFrames;
+            if ((err = snd_pcm_hw_params_set_period_size_near (m_captureHandle, m_hwParams, &periodSize, 0)) < 0) {
+                fprintf (stderr, "cannot set period size (%s)\n", snd_strerror (err));
+                return kUnknownError;
+            }
+            fprintf(stdout, "hw_params period size set\n");
+        }
+
         if ((err = snd_pcm_hw_params (m_captureHandle, m_hwParams)) < 0) {
             fprintf (stderr, "cannot set parameters (%s)\n", snd_strerror (err));
             return kUnknownError;
@@ -107,24 +147,62 @@ public:
 
     void AllocateMemory() {
         m_piBuffer = new int16_t[m_iBufferSize];
+        m_pQueue = std::make_unique<SpscQueue<float>>(m_iBufferSize * kQueueLengthInPeriods);
+    }
+
+    /* Starts the capture thread */
+    Error_t Start() {
+        if (!m_bInitialized)
+            return kNotInitializedError;
+        if (m_bCapturing)
+            return kFunctionIllegalCallError;
+
+        m_pQueue->clear();
+        m_iNumOverruns = 0;
+        m_iNumXruns = 0;
+        m_captureError = kNoError;
+        m_bCapturing = true;
+        m_captureThread = std::thread(&CRecorder::capture, this);
+        return kNoError;
+    }
+
+    /* Stops the capture thread and drops whatever the device still holds */
+    Error_t Stop() {
+        if (!m_captureThread.joinable())
+            return kNoError;
+
+        m_bCapturing = false;
+        { std::lock_guard<std::mutex> lock(m_dataMutex); }
+        m_dataReady.notify_all();
+        m_captureThread.join();
+
+        if (m_captureHandle) {
+            snd_pcm_drop(m_captureHandle);
+            snd_pcm_prepare(m_captureHandle);
+        }
+        return kNoError;
     }
 
     void Reset()
     {
+        Stop();
+
         m_sDeviceName = "plughw:1";
         m_sOutputFileName = "/home/pi/Desktop/Output.wav";
 
         delete[] m_piBuffer;
         m_piBuffer = nullptr;
 
+        m_pQueue.reset();
+
         m_pfBuffer = nullptr; // not owned by Recorder
         m_iBufferFrames = 128;
         m_iBufferSize = 0;
         m_uiSampleRate = 44100;
         m_iNumChannels = 1;
         m_format = SND_PCM_FORMAT_S16_LE;
+        m_accessMode = kReadWrite;
         m_iBitDepth = snd_pcm_format_width(m_format);;
-        m_captureHandle = nullptr;
         m_hwParams = nullptr;
 
         if (m_pStream)
@@ -140,6 +218,7 @@ public:
             snd_pcm_close(m_captureHandle);
             fprintf(stdout, "audio interface closed\n");
         }
+        m_captureHandle = nullptr;
     }
 
     void SetOutputFileName(const std::string& fileName) {
@@ -154,26 +233,50 @@ public:
         m_pStream = new std::ofstream(m_sOutputFileName, std::ios::out | std::ios::binary);
     }
 
-    Error_t Record(int index) {
+    /* Waits for the next captured period and writes it into the output buffer, treated as a circular
+     * buffer of iRingMask + 1 (power of 2) samples, starting at ring position writeIdx.
+     * Returns kTimeoutError if nothing arrives within kRecordTimeoutInPeriods periods and
+     * kFunctionExecOrderError if the capture thread is not running. */
+    Error_t Record(size_t writeIdx, size_t iRingMask) {
         if (!m_bInitialized)
             return kNotInitializedError;
 
-        int err = 0;
-        if ((err = snd_pcm_readi (m_captureHandle, m_piBuffer, m_iBufferFrames)) != m_iBufferFrames) {
-            fprintf (stderr, "read from audio interface failed (%d), (%s)\n", err, snd_strerror (err));
-            return kUnknownError;
+        if (m_pQueue->size() < m_iBufferSize) {
+            auto timeout = std::chrono::microseconds(1000000LL * kRecordTimeoutInPeriods * m_iBufferFrames / m_uiSampleRate);
+            std::unique_lock<std::mutex> lock(m_dataMutex);
+            m_dataReady.wait_for(lock, timeout, [this]() { return m_pQueue->size() >= m_iBufferSize || !m_bCapturing; });
         }
 
-        if (m_bSaveToFile) {
-            m_pStream->write((char*)m_piBuffer, m_iBufferSize);
+        if (m_pQueue->size() < m_iBufferSize) {
+            if (m_captureError != kNoError)
+                return m_captureError;
+            return m_bCapturing ? kTimeoutError : kFunctionExecOrderError;
         }
 
-        for (size_t i=0; i<m_iBufferSize; i++)
-            m_pfBuffer[i + index] = (float)(m_piBuffer[i]) / (float)(( 1 << ( m_iBitDepth - 1 )) - 1);
+        // the period is contiguous in the queue but may wrap around the end of the ring
+        size_t iStart = writeIdx & iRingMask;
+        size_t iFirstLength = std::min(m_iBufferSize, iRingMask + 1 - iStart);
+        m_pQueue->pop(&m_pfBuffer[iStart], iFirstLength);
+        m_pQueue->pop(m_pfBuffer, m_iBufferSize - iFirstLength);
 
         return kNoError;
     }
 
+    /* Periods dropped because the consumer did not keep up */
+    [[nodiscard]] size_t GetNumOverruns() const {
+        return m_iNumOverruns;
+    }
+
+    /* Device overruns reported by ALSA (the capture thread itself did not keep up) */
+    [[nodiscard]] size_t GetNumXruns() const {
+        return m_iNumXruns;
+    }
+
+    /* Access mode in use, kReadWrite if kMmap was requested but not supported */
+    [[nodiscard]] AccessMode GetAccessMode() const {
+        return m_accessMode;
+    }
+
 private:
     CRecorder() : m_sDeviceName(""),
                   m_sOutputFileName("Output.wav"),
@@ -193,7 +296,139 @@ private:
         Reset();
     }
 
-    ~CRecorder() = default;
+    ~CRecorder() {
+        Stop();
+    }
+
+    void capture() {
+        if (m_accessMode == kMmap)
+            captureMmap();
+        else
+            captureReadWrite();
+
+        m_bCapturing = false;
+        { std::lock_guard<std::mutex> lock(m_dataMutex); }
+        m_dataReady.notify_all();
+    }
+
+    void captureReadWrite() {
+        const float fScale = getScale();
+
+        while (m_bCapturing) {
+            auto err = snd_pcm_readi (m_captureHandle, m_piBuffer, m_iBufferFrames);
+            if (err != m_iBufferFrames) {
+                if (err >= 0 || recover(err))
+                    continue;
+                return;
+            }
+
+            if (m_bSaveToFile) {
+                m_pStream->write((char*)m_piBuffer, m_iBufferSize * sizeof(int16_t));
+            }
+
+            bool bPushed = m_pQueue->push(m_iBufferSize, [this, fScale](size_t i) { return (float)(m_piBuffer[i]) * fScale; });
+            periodDone(bPushed);
+        }
+    }
+
+    void captureMmap() {
+        const float fScale = getScale();
+        const int iWaitTimeoutMs = (int)(1000LL * kRecordTimeoutInPeriods * m_iBufferFrames / m_uiSampleRate);
+
+        snd_pcm_start(m_captureHandle);
+        while (m_bCapturing) {
+            auto avail = snd_pcm_avail_update(m_captureHandle);
+            if (avail < 0) {
+                if (!recover(avail))
+                    return;
+                snd_pcm_start(m_captureHandle);
+                continue;
+            }
+
+            if (avail < m_iBufferFrames) {
+                snd_pcm_wait(m_captureHandle, iWaitTimeoutMs);  // an xrun shows up in the next avail_update
+                continue;
+            }
+
+            // A period can be split across the end of the DMA buffer. Its chunks are converted into a reservation
+            // in the queue, which is only published (and the file only written) once the whole period is committed.
+            // Without room in the queue the period is still taken from the device, and dropped.
+            bool bReserved = m_pQueue->reserve(m_iBufferSize);
+            long err = 0;
+            size_t iCollected = 0;
+            auto remaining = (snd_pcm_uframes_t)m_iBufferFrames;
+            while (remaining > 0) {
+                const snd_pcm_channel_area_t* pAreas = nullptr;
+                snd_pcm_uframes_t offset = 0;
+                snd_pcm_uframes_t frames = remaining;
+                if ((err = snd_pcm_mmap_begin(m_captureHandle, &pAreas, &offset, &frames)) < 0)
+                    break;
+
+                // interleaved: all channels share area 0, first and step are in bits
+                auto* piSamples = (const int16_t*)((const char*)pAreas[0].addr + (pAreas[0].first + offset * pAreas[0].step) / 8);
+                size_t iLength = frames * m_iNumChannels;
+                if (bReserved) {
+                    for (size_t i = 0; i < iLength; ++i)
+                        m_pQueue->write(iCollected + i, (float)piSamples[i] * fScale);
+                }
+                if (m_bSaveToFile)
+                    std::memcpy(m_piBuffer + iCollected, piSamples, iLength * sizeof(int16_t));
+                iCollected += iLength;
+
+                auto committed = snd_pcm_mmap_commit(m_captureHandle, offset, frames);
+                if (committed < 0 || (snd_pcm_uframes_t)committed != frames) {
+                    err = (committed < 0) ? committed : -EPIPE;
+                    break;
+                }
+                remaining -= frames;
+                err = 0;
+            }
+
+            if (err < 0) {
+                if (!recover(err))
+                    return;
+                snd_pcm_start(m_captureHandle);
+                continue;
+            }
+
+            if (m_bSaveToFile)
+                m_pStream->write((char*)m_piBuffer, m_iBufferSize * sizeof(int16_t));
+
+            if (bReserved)
+                m_pQueue->publish();
+            periodDone(bReserved);
+        }
+    }
+
+    [[nodiscard]] float getScale() const {
+        return 1.f / (float)(( 1 << ( m_iBitDepth - 1 )) - 1);
+    }
+
+    /* Counts xruns and brings the device back. Returns false (and sets the capture error) if that failed */
+    bool recover(long err) {
+        if (err == -EPIPE) {
+            ++m_iNumXruns;
+            TRACE_INFO(Trace::AudioXrun, 0, (float)m_iNumXruns);
+        }
+        if (snd_pcm_recover(m_captureHandle, (int)err, 1) >= 0)
+            return true;
+
+        fprintf (stderr, "read from audio interface failed (%ld), (%s)\n", err, snd_strerror ((int)err));
+        m_captureError = kUnknownError;
+        return false;
+    }
+
+    void periodDone(bool bPushed) {
+        if (!bPushed) {
+            ++m_iNumOverruns;
+            TRACE_INFO(Trace::AudioOverrun, 0, (float)m_iNumOverruns);
+            return;
+        }
+
+        // take the lock so that the notification can not slip in between Record()'s check and its wait
+        { std::lock_guard<std::mutex> lock(m_dataMutex); }
+        m_dataReady.notify_one();
+    }
 
     std::string m_sDeviceName;
     std::string m_sOutputFileName;
@@ -215,6 +450,18 @@ private:
 
     bool m_bInitialized;
     bool m_bSaveToFile;
+
+    AccessMode m_accessMode = kReadWrite;
+    std::unique_ptr<SpscQueue<float>> m_pQueue;
+    std::thread m_captureThread;
+    std::atomic<bool> m_bCapturing {false};
+    std::atomic<Error_t> m_captureError {kNoError};
+    std::atomic<size_t> m_iNumOverruns {0};
+    std::atomic<size_t> m_iNumXruns {0};
+
+    // only used to sleep on while the queue is empty, the queue itself is lock-free
+    std::mutex m_dataMutex;
+    std::condition_variable m_dataReady;
 };
 
 #endif //TUNER_RECORDER_H
@@ -0,0 +1,124 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#ifndef HATHAANI_SIMD_H
+#define HATHAANI_SIMD_H
+
+/*! \brief thin wrapper around the float vector instructions of the build target, picked at compile time:
+ *  NEON on ARM (aarch64 always, 32 bit ARM when built with -mfpu=neon), otherwise AVX when the compiler
+ *  has it enabled, otherwise SSE2 (always there on x86_64). SIMD_AVAILABLE is not defined if none of them
+ *  is, and the kernels in CVectorFloat / CFft fall back to their scalar loops.
+ *  Kernels are written once against Simd::Float and process Simd::kWidth values per step.
+ */
+
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_AVAILABLE
+
+namespace Simd
+{
+    using Float = float32x4_t;
+    using Mask  = uint32x4_t;
+    static const int kWidth = 4;
+
+    inline Float load (const float *pf)             { return vld1q_f32(pf); }
+    inline void store (float *pf, Float v)          { vst1q_f32(pf, v); }
+    inline Float set (float f)                      { return vdupq_n_f32(f); }
+    inline Float add (Float a, Float b)             { return vaddq_f32(a, b); }
+    inline Float mul (Float a, Float b)             { return vmulq_f32(a, b); }
+    inline Float abs (Float v)                      { return vabsq_f32(v); }
+    inline Mask greater (Float a, Float b)          { return vcgtq_f32(a, b); }
+    inline Float select (Mask m, Float a, Float b)  { return vbslq_f32(m, a, b); }
+    inline Float reverse (Float v)
+    {
+        Float r = vrev64q_f32(v);
+        return vcombine_f32(vget_high_f32(r), vget_low_f32(r));
+    }
+    inline Float sqrt (Float v)
+    {
+#if defined(__aarch64__)
+        return vsqrtq_f32(v);
+#else
+        // 32 bit NEON has no vector square root (only an estimate)
+        float af[kWidth];
+        vst1q_f32(af, v);
+        for (float &f : af)
+            f = sqrtf(f);
+        return vld1q_f32(af);
+#endif
+    }
+}
+
+#elif defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#define SIMD_AVAILABLE
+
+namespace Simd
+{
+#if defined(__AVX__)
+    using Float = __m256;
+    using Mask  = __m256;
+    static const int kWidth = 8;
+
+    inline Float load (const float *pf)             { return _mm256_loadu_ps(pf); }
+    inline void store (float *pf, Float v)          { _mm256_storeu_ps(pf, v); }
+    inline Float set (float f)                      { return _mm256_set1_ps(f); }
+    inline Float add (Float a, Float b)             { return _mm256_add_ps(a, b); }
+    inline Float mul (Float a, Float b)             { return _mm256_mul_ps(a, b); }
+    inline Float abs (Float v)                      { return _mm256_andnot_ps(_mm256_set1_ps(-0.F), v); }
+    inline Mask greater (Float a, Float b)          { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    inline Float select (Mask m, Float a, Float b)  { return _mm256_or_ps(_mm256_and_ps(m, a), _mm256_andnot_ps(m, b)); }
+    inline Float reverse (Float v)
+    {
+        Float r = _mm256_permute2f128_ps(v, v, 0x01);   // swap the 128 bit halves
+        return _mm256_permute_ps(r, 0x1B);              // reverse within each half
+    }
+    inline Float sqrt (Float v)                     { return _mm256_sqrt_ps(v); }
+#else
+    using Float = __m128;
+    using Mask  = __m128;
+    static const int kWidth = 4;
+
+    inline Float load (const float *pf)             { return _mm_loadu_ps(pf); }
+    inline void store (float *pf, Float v)          { _mm_storeu_ps(pf, v); }
+    inline Float set (float f)                      { return _mm_set1_ps(f); }
+    inline Float add (Float a, Float b)             { return _mm_add_ps(a, b); }
+    inline Float mul (Float a, Float b)             { return _mm_mul_ps(a, b); }
+    inline Float abs (Float v)                      { return _mm_andnot_ps(_mm_set1_ps(-0.F), v); }
+    inline Mask greater (Float a, Float b)          { return _mm_cmpgt_ps(a, b); }
+    inline Float select (Mask m, Float a, Float b)  { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    inline Float reverse (Float v)                  { return _mm_shuffle_ps(v, v, 0x1B); }
+    inline Float sqrt (Float v)                     { return _mm_sqrt_ps(v); }
+#endif
+}
+
+#endif
+
+#if defined(SIMD_AVAILABLE)
+namespace Simd
+{
+    /*! 0, 1, ..., kWidth - 1 */
+    inline Float ramp ()
+    {
+        static const float afRamp[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+        return load(afRamp);
+    }
+
+    /*! sum of all lanes */
+    inline float sum (Float v)
+    {
+        float af[kWidth];
+        store(af, v);
+
+        float fSum = 0;
+        for (float f : af)
+            fSum += f;
+        return fSum;
+    }
+}
+#endif
+
+#endif //HATHAANI_SIMD_H
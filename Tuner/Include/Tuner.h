@@ -11,8 +11,11 @@
 #include "MyDefinitions.h"
 #include "Recorder.h"
 #include "Fft.h"
+#include "PitchEstimator.h"
 #include "Vector.h"
 #include "Util.h"
+#include "Setpoint.h"
+#include "Trace.h"
 
 class CTuner {
 public:
@@ -29,7 +32,7 @@ public:
     static Error_t Create(CTuner*& pCInstance);
     static Error_t Destroy(CTuner*& pCInstance);
 
-    Error_t Init(float* fretPosition);
+    Error_t Init(const SetpointChannel* pSetpoint, CPitchEstimator::Type estimator = CPitchEstimator::kFftPeak);
     Error_t reset();
 
     Error_t Start();
@@ -41,7 +44,7 @@ public:
     float GetNote();
 
 private:
-    Error_t getNote(float& note, float& correction);
+    Error_t getNote(float f0, float& note, float& correction);
     static RangeID isNoteInRange(double note, double ref);
     static bool checkBounds(double note, double ref, RangeID id);
     static bool isRoot(double note, double ref);
@@ -58,26 +61,22 @@ private:
     static const int iBufferFrames = 128;
     static const int iNumChannels = 1;
     static const int iBitDepth = 16;
-    static const int iFramesPerFFT = 4;
+    static const int iWindowLength = 512;                   // analysis window, independent of the capture hop
 
-    int iBufferSizePerFrame = iBufferFrames * iNumChannels;
-    int iBufferSize = iBufferSizePerFrame * iFramesPerFFT;
+    int iBufferSizePerFrame = iBufferFrames * iNumChannels; // samples per capture (hop)
+    int m_iRingLength = CUtil::nextPowOf2(std::max(iWindowLength, iBufferSizePerFrame));
+    size_t m_iWriteIdx = 0;                                 // total samples written into the ring
 
     unsigned int m_ulSampleRate = 2000;
-    int m_iZeroPaddingFactor = 16;
-    int m_iFftLength = iBufferSize * m_iZeroPaddingFactor;
-    int m_iMagLength = 0;
 
-    float* m_pfBuffer = nullptr;
-    CFft::complex_t *m_pfFreq = nullptr;
-    float *m_pfMag = nullptr;
+    float* m_pfRing = nullptr;                              // sample history, circular
 
     CRecorder* m_pCRecorder = nullptr;
-    CFft *m_pCFft = nullptr;
+    CPitchEstimator* m_pCPitchEstimator = nullptr;
 
     constexpr static const double bandwidth = .5;
 
-    float* m_fFretPosition = nullptr;
+    const SetpointChannel* m_pSetpoint = nullptr;
     int m_iFretToNoteTransform = 3;
 };
 
@@ -6,6 +6,8 @@
 #include <limits>
 #include <cmath>
 
+#include "Simd.h"
+
 /*! \brief class with static functions for buffer operations with type T
 */
 class CVector
@@ -202,10 +204,38 @@ public:
         assert (pfSrcDest);
         assert (pfSrc);
 
-        for (int i = 0; i < iLength; i++)
+        int i = 0;
+#if defined(SIMD_AVAILABLE)
+        for (; i + Simd::kWidth <= iLength; i += Simd::kWidth)
+            Simd::store(&pfSrcDest[i], Simd::mul(Simd::load(&pfSrcDest[i]), Simd::load(&pfSrc[i])));
+#endif
+        for (; i < iLength; i++)
             pfSrcDest[i] *= pfSrc[i];
     }
 
+    /*! element-wise vector multiplication into a third buffer
+    \param pfDest output buffer
+    \param pfSrc1 first input buffer
+    \param pfSrc2 second input buffer
+    \param iLength number of element to be multiplied
+    \return void
+    */
+    static inline void mul (float *pfDest, const float *pfSrc1, const float *pfSrc2, int iLength)
+    {
+        assert (iLength >= 0);
+        assert (pfDest);
+        assert (pfSrc1);
+        assert (pfSrc2);
+
+        int i = 0;
+#if defined(SIMD_AVAILABLE)
+        for (; i + Simd::kWidth <= iLength; i += Simd::kWidth)
+            Simd::store(&pfDest[i], Simd::mul(Simd::load(&pfSrc1[i]), Simd::load(&pfSrc2[i])));
+#endif
+        for (; i < iLength; i++)
+            pfDest[i] = pfSrc1[i] * pfSrc2[i];
+    }
+
     /*! computes the scalar product between two vectors
     \param pfSrc1 vector one
     \param pfSrc2 vector two
@@ -256,7 +286,12 @@ public:
         assert (pfSrcDest);
         assert (pfSrc);
 
-        for (int i = 0; i < iLength; i++)
+        int i = 0;
+#if defined(SIMD_AVAILABLE)
+        for (; i + Simd::kWidth <= iLength; i += Simd::kWidth)
+            Simd::store(&pfSrcDest[i], Simd::add(Simd::load(&pfSrcDest[i]), Simd::load(&pfSrc[i])));
+#endif
+        for (; i < iLength; i++)
             pfSrcDest[i] += pfSrc[i];
     }
 
@@ -397,8 +432,18 @@ public:
 
         float fRms = 0;
 
-
-        for (int i=0; i < iLength; i++)
+        long long i = 0;
+#if defined(SIMD_AVAILABLE)
+        // kWidth partial sums, so the result can differ from the scalar loop in the last bits
+        Simd::Float vSum = Simd::set(0);
+        for (; i < iLength - iLength % Simd::kWidth; i += Simd::kWidth)
+        {
+            Simd::Float v = Simd::load(&pfSrc[i]);
+            vSum = Simd::add(vSum, Simd::mul(v, v));
+        }
+        fRms = Simd::sum(vSum);
+#endif
+        for (; i < iLength; i++)
         {
             fRms   += pfSrc[i] * pfSrc[i];
         }
@@ -459,7 +504,45 @@ public:
         fMax    = -std::numeric_limits<float>::max();
         iMax    = -1;
 
-        for (int i = 0; i < iLength; i++)
+        long long i = 0;
+#if defined(SIMD_AVAILABLE)
+        // per lane maximum and where it was first seen, the index is carried as a float (exact below 2^24)
+        if (iLength >= 2 * Simd::kWidth && iLength < (1 << 24))
+        {
+            Simd::Float vMax    = Simd::set(fMax);
+            Simd::Float vMaxIdx = Simd::set(-1);
+            Simd::Float vIdx    = Simd::ramp();
+            const Simd::Float vStep = Simd::set(Simd::kWidth);
+
+            for (; i < iLength - iLength % Simd::kWidth; i += Simd::kWidth)
+            {
+                Simd::Float v = Simd::load(&pfSrc[i]);
+                if (bAbs)
+                    v = Simd::abs(v);
+
+                Simd::Mask bGreater = Simd::greater(v, vMax);
+                vMax    = Simd::select(bGreater, v, vMax);
+                vMaxIdx = Simd::select(bGreater, vIdx, vMaxIdx);
+                vIdx    = Simd::add(vIdx, vStep);
+            }
+
+            // largest lane, the lowest index on ties like the scalar loop
+            float afMax[Simd::kWidth], afMaxIdx[Simd::kWidth];
+            Simd::store(afMax, vMax);
+            Simd::store(afMaxIdx, vMaxIdx);
+            for (int j = 0; j < Simd::kWidth; j++)
+            {
+                if (afMaxIdx[j] < 0)
+                    continue;
+                if (afMax[j] > fMax || (afMax[j] == fMax && afMaxIdx[j] < iMax))
+                {
+                    fMax = afMax[j];
+                    iMax = static_cast<long long>(afMaxIdx[j]);
+                }
+            }
+        }
+#endif
+        for (; i < iLength; i++)
         {
             float fCurr   = (bAbs)? std::abs(pfSrc[i]) : pfSrc[i];
 
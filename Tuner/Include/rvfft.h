@@ -3,8 +3,29 @@
 
 namespace LaszloFft
 {
+    // tables of realfft_split / irealfft_split for one length (power of 2), see rvfft.cpp
+    struct Plan
+    {
+        Plan() = default;
+        ~Plan();
+        Plan(const Plan&) = delete;
+        Plan& operator=(const Plan&) = delete;
+
+        bool init(long size);
+        void reset();
+
+        long n = 0;
+        long nswaps = 0;            // index pairs exchanged by the bit reversal
+        long *swaps = nullptr;
+        long ntwiddles = 0;         // cc1, ss1, cc3, ss3 of every stage, shortest stage first
+        float *twiddles = nullptr;
+    };
+
     void realfft_split(float *data,long n);
     void irealfft_split(float *data,long n);
+
+    void realfft_split(float *data,const Plan &plan);
+    void irealfft_split(float *data,const Plan &plan);
 }
 
 #endif //__rvfft_hdr__
@@ -0,0 +1,152 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Sweeps every CFftBackend over the FFT lengths 256 .. 16384: forward and inverse time per call, and
+// agreement with the split radix backend (max deviation of the forward spectrum relative to its peak,
+// and the round trip error of the backend itself). Exits with 1 if a backend disagrees by more than
+// kMaxRelativeError, so it doubles as a check after changes to a backend.
+// The second table is LaszloFft's split radix before and after LaszloFft::Plan: the per call
+// realfft_split / irealfft_split that computed twiddles and bit reversal every time (rvfftUnplanned.cpp),
+// the (data, n) wrappers that now build a Plan per call, and the transforms with a Plan built once.
+//
+//   FftBench
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Fft.h"
+#include "rvfft.h"
+#include "rvfftUnplanned.h"
+
+namespace {
+    const int kMinLength = 256;
+    const int kMaxLength = 16384;
+    const int kNumRuns = 11;
+    const double kMaxRelativeError = 1e-5;
+
+    const char* kBackendNames[CFftBackend::kNumBackends] = {"split radix", "packed complex"};
+
+    volatile float g_fSink;     // keeps the compiler from dropping the measured calls
+
+    /* best of kNumRuns, in us per call; the timed calls include copying the input in */
+    template <class Fn>
+    double measure(Fn&& fn, int iNumCalls) {
+        double dBest = std::numeric_limits<double>::max();
+        for (int iRun = 0; iRun < kNumRuns; iRun++) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iNumCalls; i++)
+                fn();
+            auto stop = std::chrono::steady_clock::now();
+            dBest = std::min(dBest, std::chrono::duration<double, std::micro>(stop - start).count() / iNumCalls);
+        }
+        return dBest;
+    }
+
+    double maxDeviation(const std::vector<float>& result, const std::vector<float>& reference) {
+        double dDeviation = 0, dMax = 0;
+        for (size_t i = 0; i < reference.size(); i++) {
+            dDeviation = std::max(dDeviation, (double)std::abs(result[i] - reference[i]));
+            dMax = std::max(dMax, (double)std::abs(reference[i]));
+        }
+        return (dMax > 0) ? dDeviation / dMax : dDeviation;
+    }
+}
+
+int main() {
+    CFftBackend* apCBackends[CFftBackend::kNumBackends] = {};
+    for (int b = 0; b < CFftBackend::kNumBackends; b++) {
+        if (CFftBackend::createInstance(apCBackends[b], (CFftBackend::Type)b) != kNoError) {
+            std::fprintf(stderr, "cannot create backend %d\n", b);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> value(-1, 1);
+    int iNumFailures = 0;
+
+    std::printf("%6s  %-15s %10s %10s %12s %12s\n", "N", "backend", "fwd us", "inv us", "vs split", "round trip");
+    for (int N = kMinLength; N <= kMaxLength; N *= 2) {
+        std::vector<float> input(N), reference(N), data(N);
+        for (float& f : input)
+            f = value(rng);
+        int iNumCalls = std::max(1, 500000 / N);
+
+        for (int b = 0; b < CFftBackend::kNumBackends; b++) {
+            CFftBackend* pCBackend = apCBackends[b];
+            if (pCBackend->initInstance(N) != kNoError) {
+                std::printf("%6d  %-15s initInstance failed\n", N, kBackendNames[b]);
+                iNumFailures++;
+                continue;
+            }
+
+            data = input;
+            pCBackend->forward(data.data());
+            if (b == CFftBackend::kSplitRadix)
+                reference = data;
+            double dDeviation = maxDeviation(data, reference);
+
+            pCBackend->inverse(data.data());
+            double dRoundTrip = maxDeviation(data, input);
+
+            double dForwardUs = measure([&] { data = input; pCBackend->forward(data.data()); g_fSink = data[1]; }, iNumCalls);
+            double dInverseUs = measure([&] { data = reference; pCBackend->inverse(data.data()); g_fSink = data[1]; }, iNumCalls);
+
+            bool bFailed = (dDeviation > kMaxRelativeError || dRoundTrip > kMaxRelativeError);
+            iNumFailures += bFailed;
+            std::printf("%6d  %-15s %10.2f %10.2f %12.2g %12.2g%s\n", N, kBackendNames[b], dForwardUs, dInverseUs,
+                        dDeviation, dRoundTrip, bFailed ? "  FAIL" : "");
+        }
+    }
+
+    std::printf("\n%6s  %-15s %10s %10s %12s\n", "N", "split radix", "fwd us", "inv us", "vs planned");
+    for (int N = kMinLength; N <= kMaxLength; N *= 2) {
+        std::vector<float> input(N), reference(N), spectrum(N), data(N);
+        for (float& f : input)
+            f = value(rng);
+        int iNumCalls = std::max(1, 500000 / N);
+
+        LaszloFft::Plan plan;
+        if (!plan.init(N)) {
+            std::printf("%6d  Plan::init failed\n", N);
+            iNumFailures++;
+            continue;
+        }
+        reference = input;
+        LaszloFft::realfft_split(reference.data(), plan);
+
+        data = input;
+        LaszloFft::realfft_split(data.data(), N);
+        double dWrapperDeviation = maxDeviation(data, reference);
+        data = input;
+        LaszloFftUnplanned::realfft_split(data.data(), N);
+        double dUnplannedDeviation = maxDeviation(data, reference);
+
+        bool bFailed = (dWrapperDeviation > kMaxRelativeError || dUnplannedDeviation > kMaxRelativeError);
+        iNumFailures += bFailed;
+
+        std::printf("%6d  %-15s %10.2f %10.2f %12s\n", N, "planned",
+                    measure([&] { data = input; LaszloFft::realfft_split(data.data(), plan); g_fSink = data[1]; }, iNumCalls),
+                    measure([&] { data = reference; LaszloFft::irealfft_split(data.data(), plan); g_fSink = data[1]; }, iNumCalls),
+                    "");
+        std::printf("%6d  %-15s %10.2f %10.2f %12.2g\n", N, "plan per call",
+                    measure([&] { data = input; LaszloFft::realfft_split(data.data(), N); g_fSink = data[1]; }, iNumCalls),
+                    measure([&] { data = reference; LaszloFft::irealfft_split(data.data(), N); g_fSink = data[1]; }, iNumCalls),
+                    dWrapperDeviation);
+        std::printf("%6d  %-15s %10.2f %10.2f %12.2g%s\n", N, "unplanned",
+                    measure([&] { data = input; LaszloFftUnplanned::realfft_split(data.data(), N); g_fSink = data[1]; }, iNumCalls),
+                    measure([&] { data = reference; LaszloFftUnplanned::irealfft_split(data.data(), N); g_fSink = data[1]; }, iNumCalls),
+                    dUnplannedDeviation, bFailed ? "  FAIL" : "");
+    }
+
+    for (auto& pCBackend : apCBackends)
+        CFftBackend::destroyInstance(pCBackend);
+
+    return (iNumFailures == 0) ? 0 : 1;
+}
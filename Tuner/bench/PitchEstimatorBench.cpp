@@ -0,0 +1,165 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Accuracy and latency of the pitch estimators on synthetic bowed tones at the tuner's settings:
+// 2 kHz, 512 sample blocks, fundamentals 196-500 Hz with partials up to 950 Hz falling off as 1/k,
+// white noise at -40 dB. The fundamental is attenuated by a1 to mimic tones whose harmonics dominate.
+//
+//   PitchEstimatorBench [trials per setting]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Fft.h"
+#include "PitchEstimator.h"
+
+namespace {
+    const float kSampleRate = 2000;
+    const int kBlockLength = 512;
+    const float kMinF0 = 196;
+    const float kMaxF0 = 500;
+    const float kMaxPartialFreq = 950;
+    const float kNoiseLevel = .01f;
+    const float kGrossErrorCents = 50;      // further off than this counts as a wrong note (octave, harmonic)
+
+    /* CTuner's peak picking as it was before CPitchEstimator, kept verbatim as the reference */
+    class CUnmodifiedFftEstimator {
+    public:
+        ~CUnmodifiedFftEstimator() {
+            if (m_pCFft) {
+                m_pCFft->resetInstance();
+                CFft::destroyInstance(m_pCFft);
+            }
+            delete[] m_pfSpectrum;
+            delete[] m_pfMag;
+        }
+
+        Error_t init(int iBlockLength, float fSampleRate) {
+            CFft::createInstance(m_pCFft);
+            auto err = m_pCFft->initInstance(iBlockLength, 16, CFft::kWindowHamming, CFft::kNoWindow);
+            if (err != kNoError)
+                return err;
+
+            m_fSampleRate = fSampleRate;
+            m_iMagLength = m_pCFft->getLength(CFft::kLengthMagnitude);
+            m_pfSpectrum = new CFft::complex_t [m_pCFft->getLength(CFft::kLengthFft)];
+            m_pfMag = new float [m_iMagLength];
+            return kNoError;
+        }
+
+        Error_t process(float& fF0, const float* pfRing, int iRingLength, int iStartIdx) {
+            m_pCFft->doFft(m_pfSpectrum, pfRing, iRingLength, iStartIdx);
+            m_pCFft->getMagnitude(m_pfMag, m_pfSpectrum);
+
+            auto argmax = std::distance(m_pfMag + 1, std::max_element(m_pfMag, m_pfMag + m_iMagLength / 2));
+            auto x = m_pCFft->interpolate(m_pfMag, argmax, m_iMagLength / 2);
+            fF0 = std::max(m_pCFft->bin2freq(argmax + x, m_fSampleRate), 0.f);
+            return kNoError;
+        }
+
+    private:
+        CFft* m_pCFft = nullptr;
+        CFft::complex_t* m_pfSpectrum = nullptr;
+        float* m_pfMag = nullptr;
+        int m_iMagLength = 0;
+        float m_fSampleRate = 0;
+    };
+
+    struct Result {
+        int iNumGross = 0;
+        int iNumCorrect = 0;
+        double dSumAbsCents = 0;
+        double dSumUs = 0;
+    };
+
+    void generateTone(std::vector<float>& block, float fF0, float fA1, std::mt19937& rng) {
+        std::uniform_real_distribution<float> phase(0, 2 * (float)M_PI);
+        std::normal_distribution<float> noise(0, kNoiseLevel);
+
+        std::vector<float> afPhase;
+        for (int k = 1; k * fF0 <= kMaxPartialFreq; k++)
+            afPhase.push_back(phase(rng));
+
+        for (int i = 0; i < (int)block.size(); i++) {
+            float fSample = 0;
+            for (int k = 1; k <= (int)afPhase.size(); k++) {
+                float fAmplitude = (k == 1 ? fA1 : 1.f) / (float)k;
+                fSample += fAmplitude * std::sin(2 * (float)M_PI * fF0 * k * (float)i / kSampleRate + afPhase[k - 1]);
+            }
+            block[i] = .3f * fSample + noise(rng);
+        }
+    }
+
+    template <class Estimator>
+    void measure(Result& result, Estimator& estimator, const std::vector<float>& block, float fF0) {
+        float fEstimate = 0;
+        auto start = std::chrono::steady_clock::now();
+        estimator.process(fEstimate, block.data(), kBlockLength, 0);
+        auto stop = std::chrono::steady_clock::now();
+        result.dSumUs += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        double dCents = (fEstimate > 0) ? 1200 * std::log2(fEstimate / fF0) : 1e9;
+        if (std::abs(dCents) > kGrossErrorCents) {
+            result.iNumGross++;
+        } else {
+            result.iNumCorrect++;
+            result.dSumAbsCents += std::abs(dCents);
+        }
+    }
+
+    void print(const char* pcName, const Result& result, int iNumTrials) {
+        std::printf("  %-16s %8.1f us  %6.1f %% gross  %6.2f cents\n", pcName, result.dSumUs / iNumTrials,
+                    100. * result.iNumGross / iNumTrials, result.iNumCorrect ? result.dSumAbsCents / result.iNumCorrect : 0.);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iNumTrials = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    if (iNumTrials <= 0) {
+        std::fprintf(stderr, "usage: %s [trials per setting]\n", argv[0]);
+        return 1;
+    }
+
+    CPitchEstimator* pCYin = nullptr;
+    CPitchEstimator* pCFftPeak = nullptr;
+    CUnmodifiedFftEstimator unmodified;
+    if (CPitchEstimator::createInstance(pCYin, CPitchEstimator::kYin) != kNoError ||
+        CPitchEstimator::createInstance(pCFftPeak, CPitchEstimator::kFftPeak) != kNoError ||
+        pCYin->initInstance(kBlockLength, kSampleRate) != kNoError ||
+        pCFftPeak->initInstance(kBlockLength, kSampleRate) != kNoError ||
+        unmodified.init(kBlockLength, kSampleRate) != kNoError) {
+        std::fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    std::printf("%d trials per setting, mean latency, gross error rate, mean error of the correct ones\n", iNumTrials);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> f0(kMinF0, kMaxF0);
+    std::vector<float> block(kBlockLength);
+    for (float fA1 : {1.f, .3f, .1f}) {
+        Result yin, fftPeak, fftUnmodified;
+        for (int t = 0; t < iNumTrials; t++) {
+            float fF0 = f0(rng);
+            generateTone(block, fF0, fA1, rng);
+            measure(yin, *pCYin, block, fF0);
+            measure(fftPeak, *pCFftPeak, block, fF0);
+            measure(fftUnmodified, unmodified, block, fF0);
+        }
+
+        std::printf("a1 = %.1f\n", fA1);
+        print("YIN", yin, iNumTrials);
+        print("FFT peak", fftPeak, iNumTrials);
+        print("FFT unmodified", fftUnmodified, iNumTrials);
+    }
+
+    CPitchEstimator::destroyInstance(pCYin);
+    CPitchEstimator::destroyInstance(pCFftPeak);
+    return 0;
+}
@@ -0,0 +1,132 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// Per kernel time of the SIMD CVectorFloat / CFft kernels next to the scalar loops they replaced,
+// compiled with the same flags. Reports the best of several runs in ns per call.
+//
+//   VectorBench
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Fft.h"
+#include "Vector.h"
+
+namespace {
+    const int kNumRuns = 15;
+
+    volatile float g_fSink;     // keeps the compiler from dropping the measured calls
+
+    template <class Fn>
+    double measure(Fn&& fn, int iNumCalls) {
+        double dBest = std::numeric_limits<double>::max();
+        for (int iRun = 0; iRun < kNumRuns; iRun++) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iNumCalls; i++)
+                fn();
+            auto stop = std::chrono::steady_clock::now();
+            dBest = std::min(dBest, std::chrono::duration<double, std::nano>(stop - start).count() / iNumCalls);
+        }
+        return dBest;
+    }
+
+    void print(const char* pcKernel, int iLength, double dSimdNs, double dScalarNs) {
+        std::printf("  %-16s %6d  %9.1f ns  %9.1f ns  %5.2fx\n", pcKernel, iLength, dSimdNs, dScalarNs, dScalarNs / dSimdNs);
+    }
+
+    // the loops CVectorFloat and CFft::getMagnitude used before the SIMD kernels
+    void mulScalar(float* pfDest, const float* pfSrc1, const float* pfSrc2, int iLength) {
+        for (int i = 0; i < iLength; i++)
+            pfDest[i] = pfSrc1[i] * pfSrc2[i];
+    }
+
+    void addScalar(float* pfSrcDest, const float* pfSrc, int iLength) {
+        for (int i = 0; i < iLength; i++)
+            pfSrcDest[i] += pfSrc[i];
+    }
+
+    float rmsScalar(const float* pfSrc, int iLength) {
+        float fRms = 0;
+        for (int i = 0; i < iLength; i++)
+            fRms += pfSrc[i] * pfSrc[i];
+        return std::sqrt(fRms / (float)iLength);
+    }
+
+    void findMaxScalar(const float* pfSrc, float& fMax, long long& iMax, int iLength) {
+        fMax = -std::numeric_limits<float>::max();
+        iMax = -1;
+        for (int i = 0; i < iLength; i++) {
+            if (pfSrc[i] > fMax) {
+                fMax = pfSrc[i];
+                iMax = i;
+            }
+        }
+    }
+
+    void magnitudeScalar(float* pfMag, const float* pfSpectrum, int iFftLength) {
+        int iNyq = iFftLength >> 1;
+        pfMag[0] = std::abs(pfSpectrum[0]);
+        pfMag[iNyq] = std::abs(pfSpectrum[iNyq]);
+        for (int i = 1; i < iNyq; i++)
+            pfMag[i] = sqrtf(pfSpectrum[i] * pfSpectrum[i] + pfSpectrum[iFftLength - i] * pfSpectrum[iFftLength - i]);
+    }
+}
+
+int main() {
+#if defined(SIMD_AVAILABLE)
+    std::printf("SIMD width %d\n", Simd::kWidth);
+#else
+    std::printf("no SIMD, both columns run the scalar loops\n");
+#endif
+    std::printf("  %-16s %6s  %12s  %12s  %6s\n", "kernel", "length", "SIMD", "scalar", "speedup");
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> value(-1, 1);
+
+    for (int iLength : {512, 8192}) {
+        std::vector<float> a(iLength), b(iLength), c(iLength);
+        for (float& f : a)
+            f = value(rng);
+        for (float& f : b)
+            f = value(rng);
+        int iNumCalls = 2000000 / iLength;
+
+        print("mul", iLength,
+              measure([&] { CVectorFloat::mul(c.data(), a.data(), b.data(), iLength); g_fSink = c[1]; }, iNumCalls),
+              measure([&] { mulScalar(c.data(), a.data(), b.data(), iLength); g_fSink = c[1]; }, iNumCalls));
+        print("add_I", iLength,
+              measure([&] { CVectorFloat::add_I(c.data(), b.data(), iLength); g_fSink = c[1]; }, iNumCalls),
+              measure([&] { addScalar(c.data(), b.data(), iLength); g_fSink = c[1]; }, iNumCalls));
+        print("getRms", iLength,
+              measure([&] { g_fSink = CVectorFloat::getRms(a.data(), iLength); }, iNumCalls),
+              measure([&] { g_fSink = rmsScalar(a.data(), iLength); }, iNumCalls));
+
+        float fMax;
+        long long iMax;
+        print("findMax", iLength,
+              measure([&] { CVectorFloat::findMax(a.data(), fMax, iMax, iLength); g_fSink = fMax; }, iNumCalls),
+              measure([&] { findMaxScalar(a.data(), fMax, iMax, iLength); g_fSink = fMax; }, iNumCalls));
+    }
+
+    // the tuner's spectrum: 512 samples zero padded by 16
+    CFft* pCFft = nullptr;
+    CFft::createInstance(pCFft);
+    pCFft->initInstance(512, 16);
+    int iFftLength = pCFft->getLength(CFft::kLengthFft);
+    std::vector<float> spectrum(iFftLength), mag(pCFft->getLength(CFft::kLengthMagnitude));
+    for (float& f : spectrum)
+        f = value(rng);
+
+    print("getMagnitude", iFftLength,
+          measure([&] { pCFft->getMagnitude(mag.data(), spectrum.data()); g_fSink = mag[1]; }, 200),
+          measure([&] { magnitudeScalar(mag.data(), spectrum.data(), iFftLength); g_fSink = mag[1]; }, 200));
+
+    CFft::destroyInstance(pCFft);
+    return 0;
+}
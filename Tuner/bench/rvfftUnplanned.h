@@ -0,0 +1,15 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#if !defined(__rvfftUnplanned_hdr__)
+#define __rvfftUnplanned_hdr__
+
+// LaszloFft::realfft_split / irealfft_split before LaszloFft::Plan, see rvfftUnplanned.cpp
+namespace LaszloFftUnplanned
+{
+    void realfft_split(float *data,long n);
+    void irealfft_split(float *data,long n);
+}
+
+#endif
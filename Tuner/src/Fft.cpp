@@ -1,13 +1,12 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <algorithm>
 
 #include "Util.h"
 #include "Vector.h"
 #include "Fft.h"
 
-#include "rvfft.h"
-
 const float CFft::m_Pi  = static_cast<float>(M_PI);
 const float CFft::m_Pi2 = static_cast<float>(M_PI_2);
 
@@ -16,6 +15,8 @@ CFft::CFft() :
     m_pfWindowBuff(nullptr),
     m_iDataLength(0),
     m_iFftLength(0),
+    m_iZeroPadFactor(1),
+    m_bPruned(false),
     m_ePrePostWindowOpt(kNoWindow),
     m_bIsInitialized(false)
 {
@@ -43,21 +44,28 @@ Error_t CFft::destroyInstance( CFft*& pCFft )
     return kNoError;
 }
 
-Error_t CFft::initInstance( int iBlockLength, int iZeroPadFactor, WindowFunction_t eWindow /*= kWindowHann*/, Windowing_t eWindowing /*= kPreWindow*/ )
+Error_t CFft::initInstance( int iBlockLength, int iZeroPadFactor, WindowFunction_t eWindow /*= kWindowHann*/, Windowing_t eWindowing /*= kPreWindow*/, CFftBackend::Type eBackend /*= CFftBackend::kSplitRadix*/ )
 {
     Error_t  rErr;
 
     // sanity check
     if (!CUtil::isPowOf2(iBlockLength) || iZeroPadFactor <= 0 || !CUtil::isPowOf2(iBlockLength*iZeroPadFactor))
         return kFunctionInvalidArgsError;
+    if (eBackend < 0 || eBackend >= CFftBackend::kNumBackends)
+        return kFunctionInvalidArgsError;
 
     // clean up
     resetInstance();
 
     m_iDataLength   = iBlockLength;
     m_iFftLength    = iBlockLength * iZeroPadFactor;
+    m_iZeroPadFactor = iZeroPadFactor;
+
+    // the pruned path needs one radix-4 pass and 2 * iBlockLength floats of the process buffer as scratch
+    m_bPruned       = iBlockLength >= 4 && iZeroPadFactor >= 4;
 
     m_ePrePostWindowOpt = eWindowing;
+    m_eBackend          = eBackend;
 
     rErr = allocMemory ();
     if (rErr)
@@ -76,7 +84,10 @@ Error_t CFft::resetInstance()
 
     m_iDataLength       = 0;
     m_iFftLength        = 0;
+    m_iZeroPadFactor    = 1;
+    m_bPruned           = false;
     m_ePrePostWindowOpt = kNoWindow;
+    m_eBackend          = CFftBackend::kSplitRadix;
     
     m_bIsInitialized    = false;
 
@@ -117,14 +128,52 @@ Error_t CFft::doFft( complex_t *pfSpectrum, const float *pfInput )
 
     // copy data to internal buffer
     CVectorFloat::copy(m_pfProcessBuff, pfInput, m_iDataLength);
-    CVectorFloat::setZero(&m_pfProcessBuff[m_iDataLength], m_iFftLength-m_iDataLength);
 
     // apply window function
     if (m_ePrePostWindowOpt & kPreWindow)
         CVectorFloat::mul_I(m_pfProcessBuff, m_pfWindowBuff, m_iDataLength);
 
+    return computeFft(pfSpectrum);
+}
+
+Error_t CFft::doFft( complex_t *pfSpectrum, const float *pfRing, int iRingLength, int iStartIdx )
+{
+    if (!m_bIsInitialized)
+        return kNotInitializedError;
+    if (!pfRing || !pfSpectrum || !CUtil::isPowOf2(iRingLength) || iRingLength < m_iDataLength)
+        return kFunctionInvalidArgsError;
+
+    // copy the block out of the ring in (at most) two contiguous parts
+    iStartIdx &= iRingLength - 1;
+    int iFirstLength = std::min(m_iDataLength, iRingLength - iStartIdx);
+    int iSecondLength = m_iDataLength - iFirstLength;
+
+    if (m_ePrePostWindowOpt & kPreWindow)
+    {
+        CVectorFloat::mul(m_pfProcessBuff, &pfRing[iStartIdx], m_pfWindowBuff, iFirstLength);
+        CVectorFloat::mul(&m_pfProcessBuff[iFirstLength], pfRing, &m_pfWindowBuff[iFirstLength], iSecondLength);
+    }
+    else
+    {
+        CVectorFloat::copy(m_pfProcessBuff, &pfRing[iStartIdx], iFirstLength);
+        CVectorFloat::copy(&m_pfProcessBuff[iFirstLength], pfRing, iSecondLength);
+    }
+
+    return computeFft(pfSpectrum);
+}
+
+Error_t CFft::computeFft( complex_t *pfSpectrum )
+{
+    if (m_bPruned)
+    {
+        computePrunedFft(pfSpectrum);
+        return kNoError;
+    }
+
+    CVectorFloat::setZero(&m_pfProcessBuff[m_iDataLength], m_iFftLength-m_iDataLength);
+
     // compute fft
-    LaszloFft::realfft_split(m_pfProcessBuff, m_iFftLength);
+    m_pCBackend->forward(m_pfProcessBuff);
 
     // copy data to output buffer
     CVectorFloat::copy(pfSpectrum, m_pfProcessBuff, m_iFftLength);
@@ -132,6 +181,53 @@ Error_t CFft::doFft( complex_t *pfSpectrum, const float *pfInput )
     return kNoError;
 }
 
+/*  Input pruned FFT for zero padded blocks. With N = L * P and x[n] = 0 for n >= L, bin k = P * m + r is
+ *      X[P * m + r] = sum_{n < L} (x[n] * exp(-2 pi i r n / N)) * exp(-2 pi i m n / L)
+ *  i.e. the L point FFT of x modulated by the r-th fraction of a bin. Since x is real, X[N - k] = conj(X[k]),
+ *  so r = 0 .. P/2 are enough: P/2 + 1 complex L point FFTs instead of one real N point FFT over mostly zeros.
+ *  The result is written in the same split format (and scaling) as the backends. */
+void CFft::computePrunedFft( complex_t *pfSpectrum )
+{
+    const int iHalf = m_iFftLength >> 1;
+    const float fScale = 1.F / m_iFftLength;
+    float *pfBuff = &m_pfProcessBuff[m_iDataLength];     // 2 * m_iDataLength floats, interleaved re, im
+
+    for (int r = 0; r <= m_iZeroPadFactor / 2; r++)
+    {
+        // modulate and scatter into bit reversed order
+        const float *pfModulation = &m_pfModulation[2 * r * m_iDataLength];
+        const int *piBitReverse = m_CPrunedFft.getBitReverse();
+        for (int n = 0; n < m_iDataLength; n++)
+        {
+            int j = piBitReverse[n];
+            pfBuff[2 * j]       = m_pfProcessBuff[n] * pfModulation[2 * n];
+            pfBuff[2 * j + 1]   = m_pfProcessBuff[n] * pfModulation[2 * n + 1];
+        }
+
+        m_CPrunedFft.process(pfBuff);
+
+        // re(k) goes to k, im(k) to N - k; bins above N/2 are stored through their mirror
+        for (int m = 0; m < m_iDataLength; m++)
+        {
+            int k = m_iZeroPadFactor * m + r;
+            float fReal = pfBuff[2 * m] * fScale;
+            float fImag = pfBuff[2 * m + 1] * fScale;
+
+            if (k <= iHalf)
+            {
+                pfSpectrum[k] = fReal;
+                if (k > 0 && k < iHalf)
+                    pfSpectrum[m_iFftLength - k] = fImag;
+            }
+            else
+            {
+                pfSpectrum[m_iFftLength - k] = fReal;
+                pfSpectrum[k] = -fImag;
+            }
+        }
+    }
+}
+
 Error_t CFft::doInvFft( float *pfOutput, const complex_t *pfSpectrum )
 {
     if (!m_bIsInitialized)
@@ -141,7 +237,7 @@ Error_t CFft::doInvFft( float *pfOutput, const complex_t *pfSpectrum )
     CVectorFloat::copy(m_pfProcessBuff, pfSpectrum, m_iFftLength);
     
     // compute ifft
-    LaszloFft::irealfft_split(m_pfProcessBuff, m_iFftLength);
+    m_pCBackend->inverse(m_pfProcessBuff);
 
     // apply window function
     if (m_ePrePostWindowOpt & kPostWindow)
@@ -165,7 +261,17 @@ Error_t CFft::getMagnitude( float *pfMag, const complex_t *pfSpectrum ) const
     pfMag[0]        = std::abs(pfSpectrum[0]);
     pfMag[iNyq]     = std::abs(pfSpectrum[iNyq]);
 
-    for (int i = 1; i < iNyq; i++)
+    int i = 1;
+#if defined(SIMD_AVAILABLE)
+    // the imaginary parts of bins i..i+kWidth-1 are stored backwards, ending at m_iFftLength - i
+    for (; i + Simd::kWidth <= iNyq; i += Simd::kWidth)
+    {
+        Simd::Float vRe = Simd::load(&pfSpectrum[i]);
+        Simd::Float vIm = Simd::reverse(Simd::load(&pfSpectrum[m_iFftLength - i - Simd::kWidth + 1]));
+        Simd::store(&pfMag[i], Simd::sqrt(Simd::add(Simd::mul(vRe, vRe), Simd::mul(vIm, vIm))));
+    }
+#endif
+    for (; i < iNyq; i++)
     {
         int iImagIdx    = m_iFftLength - i;
         pfMag[i]        = sqrtf(pfSpectrum[i]*pfSpectrum[i] + pfSpectrum[iImagIdx]*pfSpectrum[iImagIdx]);
@@ -250,19 +356,47 @@ Error_t CFft::allocMemory()
 
     if (!m_pfProcessBuff || !m_pfWindowBuff)
         return kMemError;
-    else
+
+    Error_t rErr = CFftBackend::createInstance(m_pCBackend, m_eBackend);
+    if (rErr == kNoError)
+        rErr = m_pCBackend->initInstance(m_iFftLength);
+    if (rErr != kNoError)
+        return rErr;
+
+    if (m_bPruned)
+        return computePruningTables();
+
+    return kNoError;
+}
+
+Error_t CFft::computePruningTables()
+{
+    // exp(-2 pi i r n / N) for r = 0 .. P/2
+    m_pfModulation  = new float [2 * (m_iZeroPadFactor / 2 + 1) * m_iDataLength];
+    for (int r = 0; r <= m_iZeroPadFactor / 2; r++)
     {
-        return kNoError;
+        for (int n = 0; n < m_iDataLength; n++)
+        {
+            double dPhase   = -2 * M_PI * r * n / m_iFftLength;
+            m_pfModulation[2 * (r * m_iDataLength + n)]     = static_cast<float>(cos(dPhase));
+            m_pfModulation[2 * (r * m_iDataLength + n) + 1] = static_cast<float>(sin(dPhase));
+        }
     }
+
+    return m_CPrunedFft.init(m_iDataLength);
 }
 
 Error_t CFft::freeMemory()
 {
     delete [] m_pfProcessBuff;
     delete [] m_pfWindowBuff;
+    delete [] m_pfModulation;
+    CFftBackend::destroyInstance(m_pCBackend);
+    m_CPrunedFft.reset();
 
     m_pfProcessBuff = nullptr;
     m_pfWindowBuff  = nullptr;
+    m_pfModulation  = nullptr;
 
     return kNoError;
 }
@@ -0,0 +1,274 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "Fft.h"
+#include "Util.h"
+
+#include "rvfft.h"
+
+CComplexFft::~CComplexFft() {
+    reset();
+}
+
+Error_t CComplexFft::init(int iLength) {
+    if (!CUtil::isPowOf2(iLength) || iLength < 4)
+        return kFunctionInvalidArgsError;
+
+    reset();
+    m_iLength = iLength;
+
+    // the first two stages are one radix-4 pass without multiplications
+    m_pfTwiddle = new float [2 * iLength];
+    float* pfTwiddle = m_pfTwiddle;
+    for (int iStageLength = 8; iStageLength <= iLength; iStageLength <<= 1) {
+        for (int j = 0; j < iStageLength / 2; j++) {
+            double dPhase = -2 * M_PI * j / iStageLength;
+            pfTwiddle[2 * j] = static_cast<float>(cos(dPhase));
+            pfTwiddle[2 * j + 1] = static_cast<float>(sin(dPhase));
+        }
+        pfTwiddle += iStageLength;
+    }
+
+    m_piBitReverse = new int [iLength];
+    int iNumBits = 0;
+    while ((1 << iNumBits) < iLength)
+        iNumBits++;
+    for (int n = 0; n < iLength; n++) {
+        int iReversed = 0;
+        for (int b = 0; b < iNumBits; b++)
+            iReversed |= ((n >> b) & 1) << (iNumBits - 1 - b);
+        m_piBitReverse[n] = iReversed;
+    }
+
+    return kNoError;
+}
+
+void CComplexFft::reset() {
+    delete[] m_pfTwiddle;
+    delete[] m_piBitReverse;
+    m_pfTwiddle = nullptr;
+    m_piBitReverse = nullptr;
+    m_iLength = 0;
+}
+
+/*  Radix-2 decimation in time. The first two stages only need the twiddles 1 and -i and are done as one radix-4 pass. */
+void CComplexFft::process(float* pfData) const {
+    for (int i = 0; i < m_iLength; i += 4) {
+        float* p = &pfData[2 * i];
+        float ar = p[0] + p[2], ai = p[1] + p[3], br = p[0] - p[2], bi = p[1] - p[3];
+        float cr = p[4] + p[6], ci = p[5] + p[7], dr = p[4] - p[6], di = p[5] - p[7];
+
+        p[0] = ar + cr; p[1] = ai + ci;
+        p[4] = ar - cr; p[5] = ai - ci;
+        p[2] = br + di; p[3] = bi - dr;     // (dr, di) * -i
+        p[6] = br - di; p[7] = bi + dr;
+    }
+
+    const float* pfTwiddle = m_pfTwiddle;
+    for (int iStageLength = 8; iStageLength <= m_iLength; iStageLength <<= 1) {
+        int iHalf = iStageLength >> 1;
+        for (int i = 0; i < m_iLength; i += iStageLength) {
+            float* pfU = &pfData[2 * i];
+            float* pfV = &pfData[2 * (i + iHalf)];
+            for (int j = 0; j < iHalf; j++) {
+                float fWr = pfTwiddle[2 * j], fWi = pfTwiddle[2 * j + 1];
+                float fVr = pfV[2 * j] * fWr - pfV[2 * j + 1] * fWi;
+                float fVi = pfV[2 * j] * fWi + pfV[2 * j + 1] * fWr;
+                pfV[2 * j] = pfU[2 * j] - fVr;
+                pfV[2 * j + 1] = pfU[2 * j + 1] - fVi;
+                pfU[2 * j] += fVr;
+                pfU[2 * j + 1] += fVi;
+            }
+        }
+        pfTwiddle += iStageLength;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+
+Error_t CFftBackend::createInstance(CFftBackend*& pCInstance, CFftBackend::Type eType) {
+    switch (eType) {
+        case kSplitRadix:
+            pCInstance = new CSplitRadixFftBackend();
+            break;
+        case kPackedComplex:
+            pCInstance = new CPackedComplexFftBackend();
+            break;
+        default:
+            pCInstance = nullptr;
+            return kFunctionInvalidArgsError;
+    }
+
+    return kNoError;
+}
+
+Error_t CFftBackend::destroyInstance(CFftBackend*& pCInstance) {
+    if (!pCInstance)
+        return kNoError;
+
+    pCInstance->resetInstance();
+    delete pCInstance;
+    pCInstance = nullptr;
+
+    return kNoError;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+CSplitRadixFftBackend::~CSplitRadixFftBackend() {
+    CSplitRadixFftBackend::resetInstance();
+}
+
+Error_t CSplitRadixFftBackend::initInstance(int iFftLength) {
+    if (!CUtil::isPowOf2(iFftLength))
+        return kFunctionInvalidArgsError;
+
+    resetInstance();
+
+    m_pPlan = new LaszloFft::Plan();
+    if (!m_pPlan->init(iFftLength))
+        return kFunctionInvalidArgsError;
+
+    return kNoError;
+}
+
+Error_t CSplitRadixFftBackend::resetInstance() {
+    delete m_pPlan;
+    m_pPlan = nullptr;
+    return kNoError;
+}
+
+void CSplitRadixFftBackend::forward(float* pfData) {
+    LaszloFft::realfft_split(pfData, *m_pPlan);
+}
+
+void CSplitRadixFftBackend::inverse(float* pfData) {
+    LaszloFft::irealfft_split(pfData, *m_pPlan);
+}
+
+// ---------------------------------------------------------------------------------------------
+
+CPackedComplexFftBackend::~CPackedComplexFftBackend() {
+    CPackedComplexFftBackend::resetInstance();
+}
+
+Error_t CPackedComplexFftBackend::initInstance(int iFftLength) {
+    if (!CUtil::isPowOf2(iFftLength) || iFftLength < 8)
+        return kFunctionInvalidArgsError;
+
+    resetInstance();
+
+    auto err = m_CComplexFft.init(iFftLength / 2);
+    if (err != kNoError)
+        return err;
+
+    m_iFftLength = iFftLength;
+    m_pfScratch = new float [iFftLength];
+    m_pfTwiddle = new float [2 * (iFftLength / 4 + 1)];
+    for (int k = 0; k <= iFftLength / 4; k++) {
+        double dPhase = -2 * M_PI * k / iFftLength;
+        m_pfTwiddle[2 * k] = static_cast<float>(cos(dPhase));
+        m_pfTwiddle[2 * k + 1] = static_cast<float>(sin(dPhase));
+    }
+
+    return kNoError;
+}
+
+Error_t CPackedComplexFftBackend::resetInstance() {
+    m_CComplexFft.reset();
+
+    delete[] m_pfTwiddle;
+    delete[] m_pfScratch;
+    m_pfTwiddle = nullptr;
+    m_pfScratch = nullptr;
+    m_iFftLength = 0;
+
+    return kNoError;
+}
+
+/*  z[n] = x[2n] + i x[2n+1] has the spectrum Z[k] = E[k] + i O[k], with E and O the (hermitian) spectra of the
+ *  even and odd samples. With A = Z[k] and B = conj(Z[M-k]), M = N/2:
+ *      E[k] = (A + B) / 2,  O[k] = -i (A - B) / 2,  X[k] = E[k] + W^k O[k],  X[M-k] = conj(E[k] - W^k O[k])
+ *  so every pair of bins k, M-k comes out of one pair of complex values. */
+void CPackedComplexFftBackend::forward(float* pfData) {
+    const int iHalf = m_iFftLength >> 1;
+    const float fScale = 1.F / m_iFftLength;
+    const int* piBitReverse = m_CComplexFft.getBitReverse();
+    float* pfZ = m_pfScratch;
+
+    for (int n = 0; n < iHalf; n++) {
+        int j = piBitReverse[n];
+        pfZ[2 * j] = pfData[2 * n];
+        pfZ[2 * j + 1] = pfData[2 * n + 1];
+    }
+
+    m_CComplexFft.process(pfZ);
+
+    // DC and Nyquist are the sum and difference of the even and odd DC
+    pfData[0] = (pfZ[0] + pfZ[1]) * fScale;
+    pfData[iHalf] = (pfZ[0] - pfZ[1]) * fScale;
+
+    for (int k = 1; k <= iHalf / 2; k++) {
+        int iMirror = iHalf - k;
+        float fAr = pfZ[2 * k], fAi = pfZ[2 * k + 1];
+        float fBr = pfZ[2 * iMirror], fBi = -pfZ[2 * iMirror + 1];
+
+        float fEr = .5F * (fAr + fBr), fEi = .5F * (fAi + fBi);
+        float fOr = .5F * (fAi - fBi), fOi = -.5F * (fAr - fBr);
+
+        float fWr = m_pfTwiddle[2 * k], fWi = m_pfTwiddle[2 * k + 1];
+        float fTr = fWr * fOr - fWi * fOi, fTi = fWr * fOi + fWi * fOr;
+
+        pfData[k] = (fEr + fTr) * fScale;
+        pfData[m_iFftLength - k] = (fEi + fTi) * fScale;
+        if (iMirror != k) {
+            pfData[iMirror] = (fEr - fTr) * fScale;
+            pfData[iHalf + k] = (fTi - fEi) * fScale;
+        }
+    }
+}
+
+/*  The forward steps backwards: E[k] = X[k] + conj(X[M-k]), O[k] = (X[k] - conj(X[M-k])) conj(W^k), Z[M-k] = conj(E[k]) + i conj(O[k]).
+ *  The inverse complex FFT is done as conj(FFT(conj(Z))); leaving out the halves makes up for the 1/N of the forward. */
+void CPackedComplexFftBackend::inverse(float* pfData) {
+    const int iHalf = m_iFftLength >> 1;
+    const int* piBitReverse = m_CComplexFft.getBitReverse();
+    float* pfZ = m_pfScratch;
+
+    // conj(Z) scattered into bit reversed order
+    pfZ[2 * piBitReverse[0]] = pfData[0] + pfData[iHalf];
+    pfZ[2 * piBitReverse[0] + 1] = -(pfData[0] - pfData[iHalf]);
+
+    for (int k = 1; k <= iHalf / 2; k++) {
+        int iMirror = iHalf - k;
+        float fXr = pfData[k], fXi = pfData[m_iFftLength - k];
+        float fYr = pfData[iMirror], fYi = (iMirror != k) ? pfData[iHalf + k] : fXi;
+
+        float fEr = fXr + fYr, fEi = fXi - fYi;
+        float fDr = fXr - fYr, fDi = fXi + fYi;
+
+        float fWr = m_pfTwiddle[2 * k], fWi = m_pfTwiddle[2 * k + 1];
+        float fOr = fDr * fWr + fDi * fWi, fOi = fDi * fWr - fDr * fWi;
+
+        // Z[k] = E + i O, Z[M-k] = conj(E) + i conj(O)
+        int j = piBitReverse[k];
+        pfZ[2 * j] = fEr - fOi;
+        pfZ[2 * j + 1] = -(fEi + fOr);
+        if (iMirror != k) {
+            j = piBitReverse[iMirror];
+            pfZ[2 * j] = fEr + fOi;
+            pfZ[2 * j + 1] = -(fOr - fEi);
+        }
+    }
+
+    m_CComplexFft.process(pfZ);
+
+    for (int n = 0; n < iHalf; n++) {
+        pfData[2 * n] = pfZ[2 * n];
+        pfData[2 * n + 1] = -pfZ[2 * n + 1];
+    }
+}
@@ -0,0 +1,253 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "PitchEstimator.h"
+#include "Util.h"
+#include "Vector.h"
+
+Error_t CPitchEstimator::createInstance(CPitchEstimator*& pCInstance, CPitchEstimator::Type eType) {
+    switch (eType) {
+        case kFftPeak:
+            pCInstance = new CFftPitchEstimator();
+            break;
+        case kYin:
+            pCInstance = new CYinPitchEstimator();
+            break;
+        default:
+            pCInstance = nullptr;
+            return kFunctionInvalidArgsError;
+    }
+
+    return kNoError;
+}
+
+Error_t CPitchEstimator::destroyInstance(CPitchEstimator*& pCInstance) {
+    if (!pCInstance)
+        return kNoError;
+
+    pCInstance->resetInstance();
+    delete pCInstance;
+    pCInstance = nullptr;
+
+    return kNoError;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+CFftPitchEstimator::~CFftPitchEstimator() {
+    CFftPitchEstimator::resetInstance();
+}
+
+Error_t CFftPitchEstimator::initInstance(int iBlockLength, float fSampleRate, float fMinFreq, float fMaxFreq) {
+    if (fSampleRate <= 0 || fMinFreq <= 0 || fMaxFreq <= fMinFreq || fMaxFreq >= fSampleRate / 2)
+        return kFunctionInvalidArgsError;
+
+    resetInstance();
+
+    CFft::createInstance(m_pCFft);
+    auto err = m_pCFft->initInstance(iBlockLength, kZeroPaddingFactor, CFft::kWindowHamming, CFft::kNoWindow);
+    if (err != kNoError)
+        return err;
+
+    m_fSampleRate = fSampleRate;
+    m_iMinBin = (int)std::floor(m_pCFft->freq2bin(fMinFreq, fSampleRate));
+    m_iMaxBin = (int)std::ceil(m_pCFft->freq2bin(fMaxFreq, fSampleRate));
+
+    m_pfSpectrum = new CFft::complex_t [m_pCFft->getLength(CFft::kLengthFft)];
+    m_pfMag = new float [m_pCFft->getLength(CFft::kLengthMagnitude)];
+
+    return kNoError;
+}
+
+Error_t CFftPitchEstimator::resetInstance() {
+    if (m_pCFft) {
+        m_pCFft->resetInstance();
+        CFft::destroyInstance(m_pCFft);
+    }
+
+    delete[] m_pfSpectrum;
+    delete[] m_pfMag;
+    m_pfSpectrum = nullptr;
+    m_pfMag = nullptr;
+
+    return kNoError;
+}
+
+Error_t CFftPitchEstimator::process(float& fF0, const float* pfRing, int iRingLength, int iStartIdx) {
+    if (!m_pCFft)
+        return kNotInitializedError;
+
+    auto err = m_pCFft->doFft(m_pfSpectrum, pfRing, iRingLength, iStartIdx);
+    if (err != kNoError)
+        return err;
+    m_pCFft->getMagnitude(m_pfMag, m_pfSpectrum);
+
+    auto iArgMax = (int)std::distance(m_pfMag, std::max_element(m_pfMag + m_iMinBin, m_pfMag + m_iMaxBin + 1));
+    auto x = CFft::interpolate(m_pfMag, iArgMax, m_pCFft->getLength(CFft::kLengthMagnitude));
+    fF0 = std::max(m_pCFft->bin2freq((float)iArgMax + x, m_fSampleRate), 0.f);
+
+    return kNoError;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+CYinPitchEstimator::~CYinPitchEstimator() {
+    CYinPitchEstimator::resetInstance();
+}
+
+Error_t CYinPitchEstimator::initInstance(int iBlockLength, float fSampleRate, float fMinFreq, float fMaxFreq) {
+    if (!CUtil::isPowOf2(iBlockLength) || fSampleRate <= 0 || fMinFreq <= 0 || fMaxFreq <= fMinFreq || fMaxFreq >= fSampleRate / 2)
+        return kFunctionInvalidArgsError;
+
+    resetInstance();
+
+    m_iBlockLength = iBlockLength;
+    m_fSampleRate = fSampleRate;
+    m_iMinLag = std::max(2, (int)std::floor(kLagOversampling * fSampleRate / fMaxFreq));
+    m_iMaxLag = (int)std::ceil(kLagOversampling * fSampleRate / fMinFreq) + 1;    // one extra lag for the interpolation
+
+    // integer lags needed to interpolate every fractional lag, the window starts late enough for the negative ones
+    m_iMaxIntLag = m_iMaxLag / kLagOversampling + kInterpolatorHalfLength;
+    m_iWindowLength = m_iBlockLength - m_iMaxIntLag - kInterpolatorHalfLength;
+    if (m_iWindowLength < m_iMaxIntLag)
+        return kFunctionInvalidArgsError;
+
+    m_pfBlock = new float [m_iBlockLength];
+    m_pfAcf = new float [m_iMaxIntLag + kInterpolatorHalfLength + 1];
+    m_pfEnergy = new float [m_iMaxIntLag + 1];
+    m_pfDiff = new float [m_iMaxLag + 1];
+
+    // Hann windowed sinc, one set of taps per fractional phase
+    m_pfInterpolator = new float [kLagOversampling * 2 * kInterpolatorHalfLength];
+    for (int p = 0; p < kLagOversampling; p++) {
+        float* pfTaps = &m_pfInterpolator[p * 2 * kInterpolatorHalfLength];
+        for (int k = 0; k < 2 * kInterpolatorHalfLength; k++) {
+            auto fX = (float)(k - kInterpolatorHalfLength + 1) - (float)p / kLagOversampling;
+            auto fWindow = .5f + .5f * std::cos((float)M_PI * fX / kInterpolatorHalfLength);
+            pfTaps[k] = (fX == 0) ? 1 : fWindow * std::sin((float)M_PI * fX) / ((float)M_PI * fX);
+        }
+    }
+
+    return kNoError;
+}
+
+Error_t CYinPitchEstimator::resetInstance() {
+    delete[] m_pfBlock;
+    delete[] m_pfAcf;
+    delete[] m_pfEnergy;
+    delete[] m_pfDiff;
+    delete[] m_pfInterpolator;
+    m_pfBlock = nullptr;
+    m_pfAcf = nullptr;
+    m_pfEnergy = nullptr;
+    m_pfDiff = nullptr;
+    m_pfInterpolator = nullptr;
+
+    m_iBlockLength = 0;
+    m_iWindowLength = 0;
+    m_iMinLag = 0;
+    m_iMaxLag = 0;
+    m_iMaxIntLag = 0;
+
+    return kNoError;
+}
+
+Error_t CYinPitchEstimator::process(float& fF0, const float* pfRing, int iRingLength, int iStartIdx) {
+    if (!m_pfBlock)
+        return kNotInitializedError;
+    if (!pfRing || !CUtil::isPowOf2(iRingLength) || iRingLength < m_iBlockLength)
+        return kFunctionInvalidArgsError;
+
+    // unwrap the block
+    iStartIdx &= iRingLength - 1;
+    int iFirstLength = std::min(m_iBlockLength, iRingLength - iStartIdx);
+    CVectorFloat::copy(m_pfBlock, &pfRing[iStartIdx], iFirstLength);
+    CVectorFloat::copy(&m_pfBlock[iFirstLength], pfRing, m_iBlockLength - iFirstLength);
+
+    computeDifference();
+
+    // first dip below the threshold, followed down to its minimum
+    int iTau = m_iMinLag;
+    for (; iTau < m_iMaxLag; iTau++) {
+        if (m_pfDiff[iTau] < kThreshold) {
+            while (iTau + 1 < m_iMaxLag && m_pfDiff[iTau + 1] < m_pfDiff[iTau])
+                iTau++;
+            break;
+        }
+    }
+
+    // nothing below the threshold: take the global minimum if it is still periodic enough
+    if (iTau == m_iMaxLag) {
+        iTau = (int)std::distance(m_pfDiff, std::min_element(m_pfDiff + m_iMinLag, m_pfDiff + m_iMaxLag));
+        if (m_pfDiff[iTau] > kUnvoicedThreshold) {
+            fF0 = 0;
+            return kNoError;
+        }
+    }
+
+    fF0 = kLagOversampling * m_fSampleRate / interpolateMinimum(iTau);
+    return kNoError;
+}
+
+void CYinPitchEstimator::computeDifference() {
+    // d(tau) = e(0) + e(tau) - 2 r(tau) over a window starting at kInterpolatorHalfLength, so that r is
+    // also available at the small negative lags the interpolator reaches back to
+    const float* pfWindow = &m_pfBlock[kInterpolatorHalfLength];
+    float* pfAcf = &m_pfAcf[kInterpolatorHalfLength];     // pfAcf[-kInterpolatorHalfLength .. m_iMaxIntLag]
+
+    for (int iLag = 1 - kInterpolatorHalfLength; iLag <= m_iMaxIntLag; iLag++) {
+        float fSum = 0;
+        for (int j = 0; j < m_iWindowLength; j++)
+            fSum += pfWindow[j] * pfWindow[j + iLag];
+        pfAcf[iLag] = fSum;
+    }
+
+    m_pfEnergy[0] = pfAcf[0];
+    for (int iLag = 1; iLag <= m_iMaxIntLag; iLag++) {
+        auto fOld = pfWindow[iLag - 1];
+        auto fNew = pfWindow[iLag - 1 + m_iWindowLength];
+        m_pfEnergy[iLag] = m_pfEnergy[iLag - 1] - fOld * fOld + fNew * fNew;
+    }
+
+    // the signal is band limited, so r can be sinc interpolated between integer lags. The energy
+    // changes slowly with the lag and is interpolated linearly.
+    float fRunningSum = 0;
+    m_pfDiff[0] = 1;
+    for (int iTau = 1; iTau <= m_iMaxLag; iTau++) {
+        int iLag = iTau / kLagOversampling;
+        int iPhase = iTau % kLagOversampling;
+
+        float fAcf = pfAcf[iLag];
+        float fEnergy = m_pfEnergy[iLag];
+        if (iPhase) {
+            const float* pfTaps = &m_pfInterpolator[iPhase * 2 * kInterpolatorHalfLength];
+            const float* pfLags = &pfAcf[iLag - kInterpolatorHalfLength + 1];
+            fAcf = 0;
+            for (int k = 0; k < 2 * kInterpolatorHalfLength; k++)
+                fAcf += pfLags[k] * pfTaps[k];
+
+            auto fFraction = (float)iPhase / kLagOversampling;
+            fEnergy += fFraction * (m_pfEnergy[iLag + 1] - fEnergy);
+        }
+
+        float fDiff = std::max(m_pfEnergy[0] + fEnergy - 2 * fAcf, 0.f);
+        fRunningSum += fDiff;
+        m_pfDiff[iTau] = (fRunningSum > 0) ? fDiff * (float)iTau / fRunningSum : 1;
+    }
+}
+
+float CYinPitchEstimator::interpolateMinimum(int iTau) const {
+    auto y0 = m_pfDiff[iTau - 1];
+    auto y1 = m_pfDiff[iTau];
+    auto y2 = m_pfDiff[iTau + 1];
+
+    auto fDenominator = y0 - 2 * y1 + y2;
+    if (fDenominator <= 0)
+        return (float)iTau;
+
+    return (float)iTau + .5f * (y0 - y2) / fDenominator;
+}
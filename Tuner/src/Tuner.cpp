@@ -21,28 +21,25 @@ Error_t CTuner::Destroy(CTuner *&pCInstance) {
     return kNoError;
 }
 
-Error_t CTuner::Init(float* fretPosition) {
-    m_fFretPosition = fretPosition;
+Error_t CTuner::Init(const SetpointChannel* pSetpoint, CPitchEstimator::Type estimator) {
+    m_pSetpoint = pSetpoint;
 
-    m_pfBuffer  = new float [iBufferSize];
+    m_pfRing    = new float [m_iRingLength];
+    m_iWriteIdx = 0;
 
     CRecorder::Create(m_pCRecorder);
-    auto err = m_pCRecorder->Init(deviceName, m_pfBuffer, m_ulSampleRate, iBufferFrames, iNumChannels, iBitDepth, false);
+    auto err = m_pCRecorder->Init(deviceName, m_pfRing, m_ulSampleRate, iBufferFrames, iNumChannels, iBitDepth, false, CRecorder::kMmap);
     if (err != kNoError)
         return err;
 
-    CFft::createInstance(m_pCFft);
-    err = m_pCFft->initInstance(iBufferSize, m_iZeroPaddingFactor, CFft::kWindowHamming, CFft::kNoWindow);
+    err = CPitchEstimator::createInstance(m_pCPitchEstimator, estimator);
+    if (err != kNoError)
+        return err;
+    err = m_pCPitchEstimator->initInstance(iWindowLength, (float)m_ulSampleRate);
     if (err != kNoError)
         return err;
 
-    m_iFftLength = m_pCFft->getLength(CFft::kLengthFft);
-    m_iMagLength = m_pCFft->getLength(CFft::kLengthMagnitude);
-
-    m_pfFreq    = new float [m_iFftLength];
-    m_pfMag     = new float [m_iMagLength];
-
-    CVectorFloat::setZero(m_pfBuffer, iBufferSize);
+    CVectorFloat::setZero(m_pfRing, m_iRingLength);
     m_bInitialized = true;
     return kNoError;
 }
@@ -51,12 +48,9 @@ Error_t CTuner::reset() {
     m_pCRecorder->Reset();
     CRecorder::Destroy(m_pCRecorder);
 
-    m_pCFft->resetInstance();
-    CFft::destroyInstance(m_pCFft);
+    CPitchEstimator::destroyInstance(m_pCPitchEstimator);
 
-    delete[] m_pfBuffer;
-    delete[] m_pfMag;
-    delete[] m_pfFreq;
+    delete[] m_pfRing;
 
     return kNoError;
 }
@@ -68,6 +62,10 @@ Error_t CTuner::Start() {
     if (m_bRunning)
         return kUnknownError;
 
+    auto err = m_pCRecorder->Start();
+    if (err != kNoError)
+        return err;
+
     m_bInterrupted = false;
 
     std::thread([this]() {
@@ -90,31 +88,38 @@ Error_t CTuner::Start() {
 
 Error_t CTuner::Stop() {
     m_bInterrupted = true;
+    if (m_pCRecorder)
+        m_pCRecorder->Stop();
     return kNoError;
 }
 
 Error_t CTuner::Process() {
-    for (int j=iFramesPerFFT; j > 1; j--)
-        CVectorFloat::moveInMem(m_pfBuffer, iBufferSize - ( iBufferSizePerFrame * j ), iBufferSize - (iBufferSizePerFrame*(j - 1)), iBufferSizePerFrame);
-
-    auto err = m_pCRecorder->Record(iBufferSize - iBufferSizePerFrame);
+    auto err = m_pCRecorder->Record(m_iWriteIdx, m_iRingLength - 1);
     if (err != kNoError) {
+        if (m_bInterrupted)     // the recorder was stopped while we were waiting
+            return kNoError;
         CUtil::PrintError("Record", err);
         return err;
     }
+    m_iWriteIdx += iBufferSizePerFrame;
 
-    m_pCFft->doFft(m_pfFreq, m_pfBuffer);
-    m_pCFft->getMagnitude(m_pfMag, m_pfFreq);
+    // the window is the most recent iWindowLength samples, read straight out of the ring
+    float f0;
+    err = m_pCPitchEstimator->process(f0, m_pfRing, m_iRingLength, static_cast<int>((m_iWriteIdx - iWindowLength) & (m_iRingLength - 1)));
+    if (err != kNoError) {
+        CUtil::PrintError("Pitch estimation", err);
+        return err;
+    }
 
     float n, c;
-    err = getNote(n, c);
+    err = getNote(f0, n, c);
     if (err != kNoError) {
         CUtil::PrintError("getNote", err);
         return err;
     }
     m_fNote = n;
     m_fCorrection = c;
-    std::cout << m_fNote << std::endl;
+    TRACE_DEBUG(Trace::TunerNote, 0, m_fNote);
 //    std::cout << "output: " << m_fNote << " , correction: " << m_fCorrection << std::endl;
     return kNoError;
 }
@@ -155,13 +160,15 @@ bool CTuner::is5th(double note, double ref) {
     return checkBounds(note, _ref, Fifth);
 }
 
-Error_t CTuner::getNote(float& note, float& correction) {
-    auto argmax = std::distance(m_pfMag + 1, std::max_element(m_pfMag, m_pfMag + m_iMagLength / 2));
-    auto x = m_pCFft->interpolate(m_pfMag, argmax, m_iMagLength / 2);
-    auto f0 = m_pCFft->bin2freq(argmax + x, (float)m_ulSampleRate);
-    f0 = std::max(f0, 0.f);
+Error_t CTuner::getNote(float f0, float& note, float& correction) {
+    if (f0 <= 0) {
+        note = -1;
+        correction = 0;
+        return kNoError;
+    }
+
     auto n = CFft::freq2note(f0);
-    auto ref = CVectorFloat::mod<double>(*m_fFretPosition + m_iFretToNoteTransform, 12);
+    auto ref = CVectorFloat::mod<double>(m_pSetpoint->getFretPosition() + m_iFretToNoteTransform, 12);
     auto rangeID = isNoteInRange(n, ref);
     switch (rangeID) {
         case Root:
@@ -16,6 +16,8 @@
 #include <math.h>
 //#include <stdlib.h>
 
+#include "rvfft.h"
+
 #if _MSC_VER
     #pragma warning( disable: 4127 )
 #endif //_MSC_VER
@@ -653,6 +655,65 @@ void realfft_bruun(float *data, long size){
     free(data2);
 }*/
 
+/////////////////////////////////////////////////////////
+// Plan for realfft_split / irealfft_split: the bit reversal
+// swaps and the cos/sin values of every stage, computed
+// once per length instead of on every call
+
+Plan::~Plan(){
+    reset();
+}
+
+bool Plan::init(long size){
+
+    long i,j,k,n2,n8,count;
+    double a,e;
+
+    reset();
+    if (size<2 || (size&(size-1))) return false;
+    n=size;
+
+    //the swaps of the shuffling loop, in the same order
+    for (count=0,i=0,j=0; i<n-1; i++){
+        if (i<j) count++;
+        for (k=n/2; k<=j; k>>=1) j-=k;
+        j+=k;
+    }
+    nswaps=count;
+    swaps=new long[2*nswaps+1];
+    for (count=0,i=0,j=0; i<n-1; i++){
+        if (i<j) {swaps[2*count]=i; swaps[2*count+1]=j; count++;}
+        for (k=n/2; k<=j; k>>=1) j-=k;
+        j+=k;
+    }
+
+    //cc1, ss1, cc3, ss3 for j=2..n8 of every stage, shortest stage first
+    for (ntwiddles=0,n2=4; n2<=n; n2<<=1)
+        if (n2>>3 > 1) ntwiddles+=4*((n2>>3)-1);
+    twiddles=new float[ntwiddles+1];
+    for (count=0,n2=4; n2<=n; n2<<=1){
+        n8=n2>>3;
+        e=2*M_PI/n2;
+        for (j=2; j<=n8; j++){
+            a=(j-1)*e;
+            twiddles[count++]=static_cast<float>(cos(a));
+            twiddles[count++]=static_cast<float>(sin(a));
+            twiddles[count++]=static_cast<float>(cos(3*a));
+            twiddles[count++]=static_cast<float>(sin(3*a));
+        }
+    }
+
+    return true;
+}
+
+void Plan::reset(){
+    delete[] swaps;
+    delete[] twiddles;
+    swaps=0;
+    twiddles=0;
+    n=nswaps=ntwiddles=0;
+}
+
 /////////////////////////////////////////////////////////
 // Sorensen in-place split-radix FFT for real values
 // data: array of floats:
@@ -666,27 +727,22 @@ void realfft_bruun(float *data, long size){
 // Sorensen et al: Real-Valued Fast Fourier Transform Algorithms,
 // IEEE Trans. ASSP, ASSP-35, No. 6, June 1987
 
-void realfft_split(float *data,long n){
+void realfft_split(float *data,const Plan &plan){
 
   long i,j,k,i5,i6,i7,i8,i0,id,i1,i2,i3,i4,n2,n4,n8;
-  float t1,t2,t3,t4,t5,t6,a3,ss1,ss3,cc1,cc3,a,e,sqrt2;
+  long n=plan.n;
+  float t1,t2,t3,t4,t5,t6,ss1,ss3,cc1,cc3,sqrt2,scale;
+  const float *tw=plan.twiddles;
+  const long *sw;
   
   sqrt2=sqrtf(2.F);
   n4=n-1;
   
   //data shuffling
-      for (i=0,j=0,n2=n/2; i<n4 ; i++){
-      if (i<j){
-                t1=data[j];
-                data[j]=data[i];
-                data[i]=t1;
-                }
-      k=n2;
-      while (k<=j){
-                j-=k;
-                k>>=1;	
-                }
-      j+=k;
+      for (sw=plan.swaps; sw<plan.swaps+2*plan.nswaps; sw+=2){
+                t1=data[sw[1]];
+                data[sw[1]]=data[sw[0]];
+                data[sw[0]]=t1;
       }
     
 /*----------------------*/
@@ -713,7 +769,6 @@ for(k=n;k>2;k>>=1){
     n2<<=1;
     n4=n2>>2;
     n8=n2>>3;
-    e = static_cast<float>(2*M_PI/(n2));
     i1=0;
     id=n2<<1;
     do{ 
@@ -742,14 +797,12 @@ for(k=n;k>2;k>>=1){
          i1=id-n2;
          id<<=1;
       } while ( i1<n );
-    a=e;
     for (j=2; j<=n8; j++){  
-          a3=3*a;
-          cc1=cosf(a);
-          ss1=sinf(a);
-          cc3=cosf(a3);
-          ss3=sinf(a3);
-          a=j*e;
+          cc1=tw[0];
+          ss1=tw[1];
+          cc3=tw[2];
+          ss3=tw[3];
+          tw+=4;
           i=0;
           id=n2<<1;
           do{
@@ -791,7 +844,8 @@ for(k=n;k>2;k>>=1){
       }
 
     //division with array length
-   for(i=0;i<n;i++) data[i]/=n;
+   scale=1.F/n;
+   for(i=0;i<n;i++) data[i]*=scale;
 }
 
 
@@ -836,10 +890,14 @@ for(k=n;k>2;k>>=1){
 // Sorensen et al: Real-Valued Fast Fourier Transform Algorithms,
 // IEEE Trans. ASSP, ASSP-35, No. 6, June 1987
 
-void irealfft_split(float *data,long n){
+void irealfft_split(float *data,const Plan &plan){
 
   long i,j,k,i5,i6,i7,i8,i0,id,i1,i2,i3,i4,n2,n4,n8,n1;
-  float t1,t2,t3,t4,t5,a3,ss1,ss3,cc1,cc3,a,e,sqrt2;
+  long n=plan.n;
+  float t1,t2,t3,t4,t5,ss1,ss3,cc1,cc3,sqrt2;
+  const float *tw=plan.twiddles+plan.ntwiddles;
+  const float *stage;
+  const long *sw;
   
   sqrt2=sqrtf(2.F);
   
@@ -850,7 +908,9 @@ for(k=n;k>2;k>>=1){
     n2>>=1;
     n4=n2>>2;
     n8=n2>>3;
-    e = static_cast<float>(2*M_PI/(n2));
+    //the stages are stored in ascending order
+    if (n8>1) tw-=4*(n8-1);
+    stage=tw;
     i1=0;
     do{ 
         for (; i1<n; i1+=id){
@@ -879,14 +939,12 @@ for(k=n;k>2;k>>=1){
          i1=id-n2;
          id<<=1;
       } while ( i1<n1 );
-    a=e;
     for (j=2; j<=n8; j++){  
-          a3=3*a;
-          cc1=cosf(a);
-          ss1=sinf(a);
-          cc3=cosf(a3);
-          ss3=sinf(a3);
-          a=j*e;
+          cc1=stage[0];
+          ss1=stage[1];
+          cc3=stage[2];
+          ss3=stage[3];
+          stage+=4;
           i=0;
           id=n2<<1;
           do{
@@ -941,19 +999,27 @@ for(k=n;k>2;k>>=1){
 /*----------------------*/
 
 //data shuffling
-      for (i=0,j=0,n2=n/2; i<n1 ; i++){
-      if (i<j){
-                t1=data[j];
-                data[j]=data[i];
-                data[i]=t1;
-                }
-      k=n2;
-      while (k<=j){
-                j-=k;
-                k>>=1;	
-                }
-      j+=k;
-      }	
+      for (sw=plan.swaps; sw<plan.swaps+2*plan.nswaps; sw+=2){
+                t1=data[sw[1]];
+                data[sw[1]]=data[sw[0]];
+                data[sw[0]]=t1;
+      }
+}
+
+/////////////////////////////////////////////////////////
+// Same as above for a single call, builds the plan on the fly. That costs more than the transform
+// itself (about 1.5x the unplanned transform, see FftBench), so keep a Plan for repeated calls
+
+void realfft_split(float *data,long n){
+    Plan plan;
+    plan.init(n);
+    realfft_split(data,plan);
+}
+
+void irealfft_split(float *data,long n){
+    Plan plan;
+    plan.init(n);
+    irealfft_split(data,plan);
 }
 
 
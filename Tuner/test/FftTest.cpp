@@ -0,0 +1,127 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// CFft's input pruned FFT (zero pad factor 4 and up) against a full LaszloFft::realfft_split of the
+// zero padded block, for every block length and zero pad factor up to kMaxFftLength, from a plain
+// buffer and from a wrapping ring. The bins k = P * m and k = P * m + P / 2 (r = 0 and r = P / 2, the
+// two sub-transforms that have no conjugate partner among the others) are checked bin by bin as well.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Fft.h"
+#include "rvfft.h"
+
+namespace {
+    const int kMaxFftLength = 16384;
+    const int kRingLength = 2048;
+    const double kMaxRelativeError = 1e-5;
+
+    int g_iNumFailures = 0;
+
+    double maxDeviation(const std::vector<float>& result, const std::vector<float>& reference, double& dMax) {
+        double dDeviation = 0;
+        dMax = 0;
+        for (size_t i = 0; i < reference.size(); i++) {
+            dDeviation = std::max(dDeviation, (double)std::abs(result[i] - reference[i]));
+            dMax = std::max(dMax, (double)std::abs(reference[i]));
+        }
+        return dDeviation;
+    }
+
+    /* real and imaginary part of bin k in the split format re(0..N/2), im(N/2-1..1) */
+    void getBin(const std::vector<float>& spectrum, int k, float& fReal, float& fImag) {
+        int N = (int)spectrum.size();
+        fReal = spectrum[k];
+        fImag = (k == 0 || k == N / 2) ? 0 : spectrum[N - k];
+    }
+
+    void checkMirrorBins(const std::vector<float>& result, const std::vector<float>& reference, int L, int P, double dMax, const char* pcInput) {
+        int N = L * P;
+        for (int r : {0, P / 2}) {
+            for (int m = 0; m < L; m++) {
+                // bin and its conjugate mirror N - k, both only exist in the lower half
+                for (int k : {P * m + r, N - (P * m + r)}) {
+                    if (k < 0 || k > N / 2)
+                        continue;
+
+                    float fReal, fImag, fRefReal, fRefImag;
+                    getBin(result, k, fReal, fImag);
+                    getBin(reference, k, fRefReal, fRefImag);
+                    if (std::abs(fReal - fRefReal) > kMaxRelativeError * dMax || std::abs(fImag - fRefImag) > kMaxRelativeError * dMax) {
+                        std::printf("FAIL L=%d P=%d %s: bin %d (r=%d) is %g%+gi, expected %g%+gi\n", L, P, pcInput, k, r, fReal, fImag, fRefReal, fRefImag);
+                        g_iNumFailures++;
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    void testPrunedFft(int L, int P, bool bWindow, std::mt19937& rng) {
+        int N = L * P;
+        CFft* pCFft = nullptr;
+        CFft::createInstance(pCFft);
+        if (pCFft->initInstance(L, P, CFft::kWindowHann, bWindow ? CFft::kPreWindow : CFft::kNoWindow) != kNoError) {
+            std::printf("FAIL L=%d P=%d: initInstance\n", L, P);
+            g_iNumFailures++;
+            CFft::destroyInstance(pCFft);
+            return;
+        }
+
+        std::normal_distribution<float> noise;
+        std::vector<float> block(L), window(L), ring(kRingLength);
+        for (auto& fSample : block)
+            fSample = noise(rng);
+        pCFft->getWindow(window.data());
+
+        // the ring block wraps around the end
+        int iStartIdx = kRingLength - L / 3;
+        for (int i = 0; i < L; i++)
+            ring[(iStartIdx + i) & (kRingLength - 1)] = block[i];
+
+        std::vector<float> reference(N, 0.f);
+        for (int i = 0; i < L; i++)
+            reference[i] = block[i] * (bWindow ? window[i] : 1.f);
+        LaszloFft::realfft_split(reference.data(), N);
+
+        std::vector<float> result(N);
+        for (bool bRing : {false, true}) {
+            const char* pcInput = bRing ? "ring" : "buffer";
+            if (bRing)
+                pCFft->doFft(result.data(), ring.data(), kRingLength, iStartIdx);
+            else
+                pCFft->doFft(result.data(), block.data());
+
+            double dMax;
+            double dDeviation = maxDeviation(result, reference, dMax);
+            if (dDeviation > kMaxRelativeError * dMax) {
+                std::printf("FAIL L=%d P=%d window=%d %s: max deviation %g of %g\n", L, P, bWindow, pcInput, dDeviation, dMax);
+                g_iNumFailures++;
+            }
+            checkMirrorBins(result, reference, L, P, dMax, pcInput);
+        }
+
+        CFft::destroyInstance(pCFft);
+    }
+}
+
+int main() {
+    std::mt19937 rng(1);
+    int iNumCases = 0;
+    for (int L = 4; L <= kRingLength; L *= 2) {
+        for (int P = 4; L * P <= kMaxFftLength; P *= 2) {
+            for (bool bWindow : {false, true}) {
+                testPrunedFft(L, P, bWindow, rng);
+                iNumCases++;
+            }
+        }
+    }
+
+    std::printf("%d cases, %d failures\n", iNumCases, g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+//
+// Created by violinsimma on 10/17/26.
+//
+
+// The SIMD kernels of CVectorFloat and CFft::getMagnitude against plain scalar loops, over lengths
+// around the vector width so that the tails are covered, plus the Simd primitives lane by lane.
+// Element wise products and sums have to match bit for bit. getRms sums in kWidth partial sums and the
+// compiler may fuse the scalar reference's multiply-add in the magnitude (it does on aarch64), so those
+// two get a tolerance.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Fft.h"
+#include "Vector.h"
+
+namespace {
+    int g_iNumFailures = 0;
+
+    void check(bool bCondition, const char* pcKernel, int iLength) {
+        if (bCondition)
+            return;
+        std::printf("FAIL %s, length %d\n", pcKernel, iLength);
+        g_iNumFailures++;
+    }
+
+    void findMaxScalar(const float* pfSrc, float& fMax, long long& iMax, int iLength, bool bAbs) {
+        fMax = -std::numeric_limits<float>::max();
+        iMax = -1;
+        for (int i = 0; i < iLength; i++) {
+            float fCurr = bAbs ? std::abs(pfSrc[i]) : pfSrc[i];
+            if (fCurr > fMax) {
+                fMax = fCurr;
+                iMax = i;
+            }
+        }
+    }
+
+    void testElementWise(const std::vector<float>& a, const std::vector<float>& b) {
+        int iLength = (int)a.size();
+        std::vector<float> result(iLength);
+
+        CVectorFloat::mul(result.data(), a.data(), b.data(), iLength);
+        bool bEqual = true;
+        for (int i = 0; i < iLength; i++)
+            bEqual &= (result[i] == a[i] * b[i]);
+        check(bEqual, "mul", iLength);
+
+        result = a;
+        CVectorFloat::mul_I(result.data(), b.data(), iLength);
+        bEqual = true;
+        for (int i = 0; i < iLength; i++)
+            bEqual &= (result[i] == a[i] * b[i]);
+        check(bEqual, "mul_I", iLength);
+
+        result = a;
+        CVectorFloat::add_I(result.data(), b.data(), iLength);
+        bEqual = true;
+        for (int i = 0; i < iLength; i++)
+            bEqual &= (result[i] == a[i] + b[i]);
+        check(bEqual, "add_I", iLength);
+
+        if (iLength > 0) {
+            double dSum = 0;
+            for (float f : a)
+                dSum += (double)f * f;
+            double dRms = std::sqrt(dSum / iLength);
+            check(std::abs(CVectorFloat::getRms(a.data(), iLength) - dRms) <= 1e-5 * dRms, "getRms", iLength);
+        }
+    }
+
+    void testFindMax(std::vector<float> a, std::mt19937& rng) {
+        int iLength = (int)a.size();
+        std::uniform_int_distribution<int> index(0, std::max(iLength - 1, 0));
+
+        // random data, a tie (the lowest index wins), and a negative peak that only bAbs finds
+        for (int iCase = 0; iCase < 3; iCase++) {
+            if (iCase == 1 && iLength > 1) {
+                int i = index(rng), j = index(rng);
+                a[i] = a[j] = 5;
+            }
+            if (iCase == 2 && iLength > 0)
+                a[index(rng)] = -7;
+
+            for (bool bAbs : {false, true}) {
+                float fMax, fRefMax;
+                long long iMax, iRefMax;
+                CVectorFloat::findMax(a.data(), fMax, iMax, iLength, bAbs);
+                findMaxScalar(a.data(), fRefMax, iRefMax, iLength, bAbs);
+                check(fMax == fRefMax && iMax == iRefMax, bAbs ? "findMax abs" : "findMax", iLength);
+            }
+        }
+    }
+
+    void testMagnitude(std::mt19937& rng) {
+        std::uniform_real_distribution<float> value(-1, 1);
+        for (int iBlockLength : {4, 8, 16, 64, 512}) {
+            for (int iZeroPadFactor : {1, 2, 16}) {
+                CFft* pCFft = nullptr;
+                CFft::createInstance(pCFft);
+                pCFft->initInstance(iBlockLength, iZeroPadFactor);
+
+                int N = pCFft->getLength(CFft::kLengthFft);
+                int iMagLength = pCFft->getLength(CFft::kLengthMagnitude);
+                std::vector<float> spectrum(N), mag(iMagLength);
+                for (float& f : spectrum)
+                    f = value(rng);
+
+                pCFft->getMagnitude(mag.data(), spectrum.data());
+
+                bool bEqual = (mag[0] == std::abs(spectrum[0])) && (mag[N / 2] == std::abs(spectrum[N / 2]));
+                for (int k = 1; k < N / 2; k++) {
+                    float fRef = std::sqrt(spectrum[k] * spectrum[k] + spectrum[N - k] * spectrum[N - k]);
+                    bEqual &= (std::abs(mag[k] - fRef) <= 1e-6f * fRef);
+                }
+                check(bEqual, "CFft::getMagnitude", N);
+
+                CFft::destroyInstance(pCFft);
+            }
+        }
+    }
+
+#if defined(SIMD_AVAILABLE)
+    void testPrimitives() {
+        float afA[Simd::kWidth], afB[Simd::kWidth], afResult[Simd::kWidth];
+        for (int j = 0; j < Simd::kWidth; j++) {
+            afA[j] = (float)(j % 3) - 1.5f * (float)j;
+            afB[j] = (float)j * .5f - 1;
+        }
+        Simd::Float vA = Simd::load(afA);
+        Simd::Float vB = Simd::load(afB);
+
+        bool bEqual = true;
+        Simd::store(afResult, Simd::reverse(vA));
+        for (int j = 0; j < Simd::kWidth; j++)
+            bEqual &= (afResult[j] == afA[Simd::kWidth - 1 - j]);
+        check(bEqual, "Simd::reverse", Simd::kWidth);
+
+        bEqual = true;
+        Simd::store(afResult, Simd::select(Simd::greater(vA, vB), vA, vB));
+        for (int j = 0; j < Simd::kWidth; j++)
+            bEqual &= (afResult[j] == std::max(afA[j], afB[j]));
+        check(bEqual, "Simd::greater / select", Simd::kWidth);
+
+        bEqual = true;
+        Simd::store(afResult, Simd::sqrt(Simd::abs(vA)));
+        for (int j = 0; j < Simd::kWidth; j++)
+            bEqual &= (afResult[j] == std::sqrt(std::abs(afA[j])));
+        check(bEqual, "Simd::abs / sqrt", Simd::kWidth);
+
+        bEqual = true;
+        Simd::store(afResult, Simd::ramp());
+        for (int j = 0; j < Simd::kWidth; j++)
+            bEqual &= (afResult[j] == (float)j);
+        check(bEqual, "Simd::ramp", Simd::kWidth);
+
+        float fSum = 0;
+        for (float f : afB)
+            fSum += f;
+        check(Simd::sum(vB) == fSum, "Simd::sum", Simd::kWidth);
+    }
+#endif
+}
+
+int main() {
+#if defined(SIMD_AVAILABLE)
+    std::printf("SIMD width %d\n", Simd::kWidth);
+    testPrimitives();
+#else
+    std::printf("no SIMD, scalar kernels only\n");
+#endif
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> value(-1, 1);
+    for (int iLength : {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100, 512, 4097}) {
+        std::vector<float> a(iLength), b(iLength);
+        for (float& f : a)
+            f = value(rng);
+        for (float& f : b)
+            f = value(rng);
+
+        testElementWise(a, b);
+        testFindMax(a, rng);
+    }
+    testMagnitude(rng);
+
+    std::printf("%d failures\n", g_iNumFailures);
+    return (g_iNumFailures == 0) ? 0 : 1;
+}